@@ -0,0 +1,159 @@
+// $Id: benchlimbs.cpp,v 1.1 2020-02-10 11:40:17-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// benchlimbs -
+//    Time each add_n, sub_n and cmp_n kernel set this CPU can run
+//    against the scalar loops, over a range of operand sizes.  The
+//    compares are of equal operands, so every limb is looked at.
+//    Before timing anything, every set is checked against the
+//    scalar one, and a mismatch fails the run.
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <utility>
+using namespace std;
+
+#include "limbs.h"
+
+static mt19937 rng;
+
+limbvec random_limbs (size_t n) {
+   limbvec limbs (n);
+   for (auto& limb: limbs) limb = rng();
+   return limbs;
+}
+
+//Random limbs are almost never all ones or all zeros, which is where
+//a wrong carry or borrow chain would show, so half the operands are
+//made mostly of those.
+limbvec test_limbs (size_t n) {
+   limbvec limbs = random_limbs (n);
+   if (rng() % 2 == 0) {
+      for (auto& limb: limbs) {
+         switch (rng() % 4) {
+            case 0: limb = 0; break;
+            case 1: case 2: limb = ~limb_t (0); break;
+         }
+      }
+   }
+   return limbs;
+}
+
+//r = a op b for a kernel, with r apart from the operands or
+//aliasing one of them as alias says, and the carry out
+pair<limbvec, limb_t> run_kernel (
+         limb_t (*kernel) (limb_t*, const limb_t*, const limb_t*,
+                           size_t),
+         const limbvec& a, const limbvec& b, int alias) {
+   limbvec left = a, right = b;
+   limbvec result (a.size());
+   limb_t* r = alias == 1 ? left.data()
+             : alias == 2 ? right.data() : result.data();
+   limb_t carry = kernel (r, left.data(), right.data(), a.size());
+   return {limbvec (r, r + a.size()), carry};
+}
+
+//true if every set gives the scalar set's answers, else a report
+//of the first difference on cerr
+bool check_kernels (size_t cases) {
+   const auto& sets = limb_kernel_sets();
+   const limb_kernels& scalar = sets.front();
+   for (size_t test = 0; test < cases; ++test) {
+      size_t n = test % 4 == 0 ? rng() % 2048 : rng() % 80;
+      limbvec a = test_limbs (n);
+      limbvec b = test % 8 == 1 ? a : test_limbs (n);
+      if (test % 8 == 2 and n > 0) b[rng() % n] ^= 1;
+      int alias = test % 3;
+      for (const auto& kernels: sets) {
+         const char* failed = nullptr;
+         if (run_kernel (kernels.add_n, a, b, alias)
+             != run_kernel (scalar.add_n, a, b, alias)) {
+            failed = "add_n";
+         }else if (run_kernel (kernels.sub_n, a, b, alias)
+                   != run_kernel (scalar.sub_n, a, b, alias)) {
+            failed = "sub_n";
+         }else if (kernels.cmp_n (a.data(), b.data(), n)
+                   != scalar.cmp_n (a.data(), b.data(), n)) {
+            failed = "cmp_n";
+         }
+         if (failed != nullptr) {
+            cerr << kernels.name << " " << failed << " differs from "
+                 << scalar.name << " at " << n << " limbs, alias "
+                 << alias << endl;
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+//average nanoseconds for one call of operation, which is run in
+//batches so that reading the clock does not swamp the small sizes
+double time_op (const function<void()>& operation) {
+   using clock = chrono::steady_clock;
+   const auto minimum = chrono::milliseconds (50);
+   const size_t batch = 64;
+   size_t reps = 0;
+   auto start = clock::now();
+   auto elapsed = clock::duration::zero();
+   do {
+      for (size_t rep = 0; rep < batch; ++rep) operation();
+      reps += batch;
+      elapsed = clock::now() - start;
+   }while (elapsed < minimum);
+   return chrono::duration<double, nano> (elapsed).count() / reps;
+}
+
+//nanoseconds for add_n, sub_n and cmp_n of n limbs with kernels
+void time_kernels (const limb_kernels& kernels, size_t n,
+                   double times[3]) {
+   limbvec left = random_limbs (n);
+   limbvec right = random_limbs (n);
+   limbvec same = left;
+   limbvec result (n);
+   volatile int sink = 0;
+   times[0] = time_op ([&]() {
+      sink = kernels.add_n (result.data(), left.data(),
+                            right.data(), n);
+   });
+   times[1] = time_op ([&]() {
+      sink = kernels.sub_n (result.data(), left.data(),
+                            right.data(), n);
+   });
+   times[2] = time_op ([&]() {
+      sink = kernels.cmp_n (left.data(), same.data(), n);
+   });
+}
+
+int main() {
+   const auto& sets = limb_kernel_sets();
+   if (not check_kernels (20000)) return EXIT_FAILURE;
+   cout << "ns per call, with the speedup over scalar in ()" << endl;
+   cout << setw (7) << "limbs" << setw (8) << "kernels";
+   for (const char* op: {"add_n", "sub_n", "cmp_n"}) {
+      cout << setw (18) << op;
+   }
+   cout << endl << fixed;
+   for (size_t n: {8, 32, 128, 1024, 8192, 65536}) {
+      double scalar[3];
+      time_kernels (sets.front(), n, scalar);
+      for (const auto& kernels: sets) {
+         double times[3];
+         time_kernels (kernels, n, times);
+         cout << setw (7) << n << setw (8) << kernels.name;
+         for (int op = 0; op < 3; ++op) {
+            cout << setw (10) << setprecision (1) << times[op]
+                 << " (" << setprecision (2) << setw (4)
+                 << scalar[op] / times[op] << ")";
+         }
+         cout << endl;
+      }
+   }
+   return 0;
+}
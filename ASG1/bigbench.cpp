@@ -0,0 +1,181 @@
+// $Id: bigbench.cpp,v 1.1 2020-02-26 16:48:52-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// bigbench -
+//    Time each bigint operation over operand sizes from 10 digits up
+//    to 10^6 digits by powers of 10.  For a size of n digits:
+//       + - *    two n digit operands
+//       / %      a 2n digit dividend and an n digit divisor
+//       ^        an n/8 digit base to the 8th power, an n digit result
+//       parse    n digits of text to a bigint
+//       print    an n digit bigint to text
+//    Each operation is repeated for at least 100 ms, or run once if
+//    that one run takes longer.  Results go to standard output as a
+//    table.  With -o name they also go to name.csv and name.json,
+//    labeled with the -l label, so that runs of different versions
+//    can be compared.
+//    Options:
+//       -j N      use N worker threads
+//       -l label  label for this run, e.g. a version
+//       -m N      largest size in digits
+//       -o name   write name.csv and name.json
+//
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <unistd.h>
+
+#include "bigint.h"
+#include "divide.h"
+#include "libfns.h"
+#include "multiply.h"
+#include "workpool.h"
+
+static mt19937 rng;
+
+struct result {
+   string operation;
+   size_t digits;
+   size_t reps;
+   double ns_per_op;
+   double digits_per_sec;
+};
+
+//n random decimal digits with a nonzero lead
+string random_digits (size_t n) {
+   string digits (n, '0');
+   for (auto& digit: digits) {
+      digit = static_cast<char> ('0' + rng() % 10);
+   }
+   digits[0] = static_cast<char> ('1' + rng() % 9);
+   return digits;
+}
+
+//average nanoseconds and count of the repetitions of operation
+pair<double, size_t> time_op (const function<void()>& operation) {
+   using clock = chrono::steady_clock;
+   const auto minimum = chrono::milliseconds (100);
+   size_t reps = 0;
+   auto start = clock::now();
+   auto elapsed = clock::duration::zero();
+   do {
+      operation();
+      ++reps;
+      elapsed = clock::now() - start;
+   }while (elapsed < minimum);
+   return {chrono::duration<double, nano> (elapsed).count() / reps,
+           reps};
+}
+
+vector<result> run (size_t max_digits) {
+   vector<result> results;
+   for (size_t digits = 10; digits <= max_digits; digits *= 10) {
+      string text = random_digits (digits);
+      bigint left (text);
+      bigint right (random_digits (digits));
+      bigint dividend (random_digits (2 * digits));
+      bigint base (random_digits (max<size_t> (digits / 8, 1)));
+      bigint eight (8);
+      bigint sink;
+      string printed;
+      vector<pair<string, function<void()>>> operations {
+         {"+", [&]() { sink = left + right; }},
+         {"-", [&]() { sink = left - right; }},
+         {"*", [&]() { sink = left * right; }},
+         {"/", [&]() { sink = dividend / right; }},
+         {"%", [&]() { sink = dividend % right; }},
+         {"^", [&]() { sink = pow (base, eight); }},
+         {"v", [&]() { sink = isqrt (dividend); }},
+         {"G", [&]() { sink = gcd (left, right); }},
+         {"parse", [&]() { sink = bigint (text); }},
+         {"print", [&]() { printed.clear(); left.print (printed); }},
+      };
+      for (const auto& [name, operation]: operations) {
+         auto [ns, reps] = time_op (operation);
+         results.push_back ({name, digits, reps, ns,
+                             digits * 1e9 / ns});
+         const result& last = results.back();
+         cout << setw (9) << last.operation << setw (9) << last.digits
+              << setw (9) << last.reps << fixed << setprecision (0)
+              << setw (16) << last.ns_per_op << setw (16)
+              << last.digits_per_sec << endl;
+      }
+   }
+   return results;
+}
+
+void write_csv (const string& filename, const string& label,
+                const vector<result>& results) {
+   ofstream out (filename);
+   out << "label,operation,digits,reps,ns_per_op,digits_per_sec\n";
+   out << fixed << setprecision (1);
+   for (const auto& item: results) {
+      out << label << "," << item.operation << "," << item.digits << ","
+          << item.reps << "," << item.ns_per_op << ","
+          << item.digits_per_sec << "\n";
+   }
+}
+
+//the thresholds are included so a run records what it measured
+void write_json (const string& filename, const string& label,
+                 const vector<result>& results) {
+   ofstream out (filename);
+   out << fixed << setprecision (1);
+   out << "{\n  \"label\": \"" << label << "\",\n"
+       << "  \"threads\": " << worker_threads() << ",\n"
+       << "  \"thresholds\": {\"karatsuba\": "
+       << mul_thresholds::karatsuba << ", \"toom3\": "
+       << mul_thresholds::toom3 << ", \"ntt\": " << mul_thresholds::ntt
+       << ", \"burnikel_ziegler\": "
+       << div_thresholds::burnikel_ziegler << "},\n"
+       << "  \"results\": [\n";
+   for (size_t index = 0; index < results.size(); ++index) {
+      const result& item = results[index];
+      out << "    {\"operation\": \"" << item.operation
+          << "\", \"digits\": " << item.digits
+          << ", \"reps\": " << item.reps
+          << ", \"ns_per_op\": " << item.ns_per_op
+          << ", \"digits_per_sec\": " << item.digits_per_sec << "}"
+          << (index + 1 < results.size() ? ",\n" : "\n");
+   }
+   out << "  ]\n}\n";
+}
+
+int main (int argc, char** argv) {
+   size_t max_digits = 1000000;
+   string label = "ydc";
+   string output;
+   for (;;) {
+      int option = getopt (argc, argv, "j:l:m:o:");
+      if (option == EOF) break;
+      switch (option) {
+         case 'j': set_worker_threads (stoul (optarg)); break;
+         case 'l': label = optarg; break;
+         case 'm': max_digits = stoul (optarg); break;
+         case 'o': output = optarg; break;
+         default:
+            cerr << "Usage: " << argv[0]
+                 << " [-j threads] [-l label] [-m digits] [-o name]"
+                 << endl;
+            return 1;
+      }
+   }
+   cout << setw (9) << "operation" << setw (9) << "digits"
+        << setw (9) << "reps" << setw (16) << "ns per op"
+        << setw (16) << "digits per sec" << endl;
+   vector<result> results = run (max_digits);
+   if (not output.empty()) {
+      write_csv (output + ".csv", label, results);
+      write_json (output + ".json", label, results);
+   }
+   return 0;
+}
@@ -0,0 +1,157 @@
+// $Id: bigdecimal.cpp,v 1.1 2020-03-05 11:42:17-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+#include <stdexcept>
+using namespace std;
+
+#include "bigdecimal.h"
+#include "libfns.h"
+
+static const bigint ZERO (0);
+
+//shared with the radix converter, and cached, since the same few
+//scales come up over and over
+static bigint power_of_ten (size_t exponent) {
+   return bigint (upow10 (exponent));
+}
+
+static bigint magnitude (const bigint& value) {
+   return value < ZERO ? -value : value;
+}
+
+bigdecimal::bigdecimal (const bigint& integer, size_t scale):
+            unscaled(integer), scale_(scale) {
+}
+
+bigdecimal::bigdecimal (string_view that) {
+   size_t point = that.find ('.');
+   if (point == string_view::npos) {
+      unscaled = bigint (that);
+      return;
+   }
+   string digits (that.substr (0, point));
+   digits.append (that.substr (point + 1));
+   unscaled = bigint (digits);
+   scale_ = that.size() - point - 1;
+}
+
+bigint bigdecimal::rescaled (size_t scale) const {
+   if (scale > scale_) return unscaled * power_of_ten (scale - scale_);
+   if (scale < scale_) return unscaled / power_of_ten (scale_ - scale);
+   return unscaled;
+}
+
+bigint bigdecimal::integer() const {
+   return rescaled (0);
+}
+
+bigdecimal& bigdecimal::operator+= (const bigdecimal& that) {
+   size_t scale = max (scale_, that.scale_);
+   bigint addend = that.rescaled (scale);
+   unscaled = rescaled (scale);
+   scale_ = scale;
+   unscaled += addend;
+   return *this;
+}
+
+bigdecimal& bigdecimal::operator-= (const bigdecimal& that) {
+   size_t scale = max (scale_, that.scale_);
+   bigint subtrahend = that.rescaled (scale);
+   unscaled = rescaled (scale);
+   scale_ = scale;
+   unscaled -= subtrahend;
+   return *this;
+}
+
+void bigdecimal::multiply_by (const bigdecimal& that,
+                              size_t precision) {
+   size_t scale = min (scale_ + that.scale_,
+                       max ({precision, scale_, that.scale_}));
+   size_t product_scale = scale_ + that.scale_;
+   unscaled *= that.unscaled;
+   scale_ = product_scale;
+   unscaled = rescaled (scale);
+   scale_ = scale;
+}
+
+//A / 10^a divided by B / 10^b, to precision p digits, is
+//A * 10^(p + b - a) / B, truncated.  If a is the larger, the extra
+//digits come off A before dividing, which gives the same quotient.
+void bigdecimal::divide_by (const bigdecimal& that, size_t precision) {
+   if (scale_ == 0 and that.scale_ == 0 and precision == 0) {
+      unscaled /= that.unscaled;
+      return;
+   }
+   bigint divisor = that.unscaled;
+   unscaled = rescaled (precision + that.scale_);
+   unscaled /= divisor;
+   scale_ = precision;
+}
+
+//like the integer %, this takes the magnitudes of its operands, and
+//is |a| - |b| * (|a| / |b|), the quotient taken to precision
+void bigdecimal::remainder_by (const bigdecimal& that,
+                               size_t precision) {
+   if (scale_ == 0 and that.scale_ == 0 and precision == 0) {
+      unscaled %= that.unscaled;
+      return;
+   }
+   bigdecimal divisor (magnitude (that.unscaled), that.scale_);
+   bigdecimal dividend (magnitude (unscaled), scale_);
+   bigdecimal quotient (dividend);
+   quotient.divide_by (divisor, precision);
+   bigdecimal product (quotient.unscaled * divisor.unscaled,
+                       precision + divisor.scale_);
+   size_t scale = max (dividend.scale_, product.scale_);
+   unscaled = dividend.rescaled (scale) - product.rescaled (scale);
+   scale_ = scale;
+}
+
+//the exponent's fraction is ignored, as dc does
+void bigdecimal::raise_to (const bigdecimal& exponent,
+                           size_t precision) {
+   bigint power = exponent.integer();
+   bool negative = power < ZERO;
+   if (scale_ == 0 and (precision == 0 or not negative)) {
+      unscaled = pow (unscaled, power);
+      return;
+   }
+   if (negative) power = -power;
+   unsigned long times = 0;
+   size_t scale = 0;
+   if (not power.to_ulong (times)
+       or __builtin_mul_overflow (scale_, times, &scale)) {
+      throw domain_error ("exponent too large");
+   }
+   size_t base_scale = scale_;
+   unscaled = pow (unscaled, power);
+   scale_ = scale;
+   if (negative) {
+      bigdecimal reciprocal (bigint (1));
+      reciprocal.divide_by (*this, precision);
+      *this = reciprocal;
+   }else {
+      size_t target = min (scale, max (precision, base_scale));
+      unscaled = rescaled (target);
+      scale_ = target;
+   }
+}
+
+//the root of A / 10^a to s digits is the integer root of
+//A * 10^(2s - a), and 2s >= a since s >= a
+void bigdecimal::square_root (size_t precision) {
+   size_t scale = max (precision, scale_);
+   unscaled = isqrt (rescaled (2 * scale));
+   scale_ = scale;
+}
+
+void bigdecimal::print (string& out) const {
+   unscaled.print (out, scale_);
+}
+
+ostream& operator<< (ostream& out, const bigdecimal& that) {
+   string text;
+   that.print (text);
+   return out << text;
+}
@@ -0,0 +1,73 @@
+// $Id: bigdecimal.h,v 1.1 2020-03-05 11:42:17-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// bigdecimal -
+//    Decimal fixed point, held as a bigint and a scale, the number
+//    of digits after the decimal point.  Results get the scales dc
+//    gives them, where precision is the value of the k register:
+//       + -   the larger scale of the operands
+//       *     the sum of their scales, but no more than the larger
+//             of precision and the operands' scales
+//       /     precision
+//       %     the larger of the dividend's scale and precision plus
+//             the divisor's scale
+//       ^     the base's scale times the exponent, but no more than
+//             the larger of precision and the base's scale; for a
+//             negative exponent, precision
+//       v     the larger of precision and the operand's scale
+//    Digits beyond the result's scale are truncated.  With integer
+//    operands and a precision of 0, every operation is exactly the
+//    bigint one, so integer arithmetic is unchanged and no slower.
+//    Division multiplies the dividend up by a power of 10 and does
+//    one integer division, so a long quotient costs what the divide
+//    tiers charge for it, which for long operands is a Newton
+//    reciprocal and a few multiplications.
+//
+
+#ifndef __BIGDECIMAL_H__
+#define __BIGDECIMAL_H__
+
+#include <iostream>
+#include <string>
+#include <string_view>
+using namespace std;
+
+#include "bigint.h"
+
+class bigdecimal {
+   friend ostream& operator<< (ostream&, const bigdecimal&);
+   private:
+      bigint unscaled; //the value times 10^scale_
+      size_t scale_ {0};
+      //unscaled as it would be at scale, truncated if that is less
+      bigint rescaled (size_t scale) const;
+   public:
+      bigdecimal() = default;
+      bigdecimal (const bigint& integer, size_t scale = 0);
+      //digits with at most one '.', preceded by '_' if negative
+      explicit bigdecimal (string_view);
+
+      size_t scale() const { return scale_; }
+      //the value times 10^scale
+      const bigint& significand() const { return unscaled; }
+      //bits in the unscaled magnitude, a measure of its length
+      size_t bit_length() const { return unscaled.bit_length(); }
+      //the value with its fraction truncated
+      bigint integer() const;
+
+      bigdecimal& operator+= (const bigdecimal&);
+      bigdecimal& operator-= (const bigdecimal&);
+      //in place forms of the other operations, which depend on the
+      //precision; that may be this
+      void multiply_by (const bigdecimal& that, size_t precision);
+      void divide_by (const bigdecimal& that, size_t precision);
+      void remainder_by (const bigdecimal& that, size_t precision);
+      void raise_to (const bigdecimal& exponent, size_t precision);
+      void square_root (size_t precision);
+
+      //append the sign and digits with the point, as dc prints them
+      void print (string& out) const;
+};
+
+#endif
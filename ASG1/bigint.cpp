@@ -1,6 +1,9 @@
 // $Id: bigint.cpp,v 1.2 2020-01-06 13:39:55-08 - - $
 // Sasank Madineni (smadinen)
 // Perry Ralston (pdralsto)
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cstdlib>
 #include <exception>
 #include <stack>
@@ -11,19 +14,57 @@ using namespace std;
 #include "debug.h"
 #include "relops.h"
 
-bigint::bigint (long that): uvalue (that), is_negative (that < 0){
-   DEBUGF ('~', this << " -> " << uvalue)
+bigint::bigint (long that):
+                small_value (that < 0 ? 0UL - that : that),
+                is_negative (that < 0) {
+   DEBUGF ('~', this << " -> " << small_value)
 }
 
 bigint::bigint (const ubigint& uvalue_, bool is_negative_):
-                uvalue(uvalue_), is_negative(is_negative_){
-                  DEBUGF('~', this << " -> " << uvalue)
+                uvalue(uvalue_), is_small(false),
+                is_negative(is_negative_){
+   demote();
+   DEBUGF('~', this << " -> " << *this)
 }
 
-bigint::bigint (const string& that) {
+//digits go straight to the limb converter, with no string built
+bigint::bigint (string_view that) {
    // '_' signifies that a number is negative
    is_negative = that.size() > 0 and that[0] == '_';
-   uvalue = ubigint (that.substr (is_negative ? 1 : 0));
+   if (is_negative) that.remove_prefix (1);
+   auto is_digit = [](unsigned char digit) { return isdigit (digit); };
+   //up to 19 decimal digits always fit in 64 bits
+   if (that.size() <= 19
+       and all_of (that.begin(), that.end(), is_digit)) {
+      for (char digit: that) {
+         small_value = small_value * 10 + (digit - '0');
+      }
+      return;
+   }
+   uvalue = ubigint (that);
+   is_small = false;
+   demote();
+}
+
+//Move an inline magnitude out to uvalue before a limb operation.
+void bigint::promote() {
+   if (not is_small) return;
+   uvalue = ubigint (small_value);
+   is_small = false;
+}
+
+//Move the magnitude back inline if it fits, releasing the limbs.
+void bigint::demote() {
+   if (is_small or not uvalue.fits_ulong (small_value)) return;
+   uvalue = ubigint();
+   is_small = true;
+}
+
+//The magnitude as a ubigint, built in scratch if it is inline.
+const ubigint& bigint::magnitude (ubigint& scratch) const {
+   if (not is_small) return uvalue;
+   scratch = ubigint (small_value);
+   return scratch;
 }
 
 bigint bigint::operator+ () const {
@@ -31,94 +72,272 @@ bigint bigint::operator+ () const {
 }
 
 bigint bigint::operator- () const {
-   return {uvalue, not is_negative};
+   bigint result {*this};
+   result.is_negative = not is_negative;
+   return result;
 }
 
+//The binary operators copy the left operand and apply the
+//compound operator, so the sign rules live in one place.
+
 bigint bigint::operator+ (const bigint& that) const {
-  ubigint result; //the magnitude of the result
-  bool neg = false; //the negativity of the result
+   bigint result {*this};
+   return result += that;
+}
+
+bigint bigint::operator- (const bigint& that) const {
+   bigint result {*this};
+   return result -= that;
+}
+
+bigint bigint::operator* (const bigint& that) const {
+   bigint result {*this};
+   return result *= that;
+}
+
+bigint bigint::operator/ (const bigint& that) const {
+   bigint result {*this};
+   return result /= that;
+}
+
+bigint bigint::operator% (const bigint& that) const {
+   bigint result {*this};
+   return result %= that;
+}
+
+bigint bigint::operator<< (size_t bits) const {
+   bigint result {*this};
+   return result <<= bits;
+}
+
+bigint bigint::operator>> (size_t bits) const {
+   bigint result {*this};
+   return result >>= bits;
+}
+
+//Each compound operator first tries the inline form, where the
+//__builtin_*_overflow checks catch the results that no longer fit.
+//Anything else falls through to the same sign rules on ubigint.
+
+bigint& bigint::operator+= (const bigint& that) {
+  if (is_small and that.is_small) {
+    unsigned long sum;
+    if (is_negative != that.is_negative) {
+      if (that.small_value < small_value) {
+        small_value -= that.small_value;
+      }else {
+        small_value = that.small_value - small_value;
+        is_negative = that.is_negative;
+      }
+      return *this;
+    }
+    if (not __builtin_add_overflow (small_value, that.small_value,
+                                    &sum)) {
+      small_value = sum;
+      return *this;
+    }
+  }
+  ubigint scratch;
+  const ubigint& that_uvalue = that.magnitude (scratch);
+  promote();
   if(is_negative == that.is_negative) {
     //case 1: A + B where A and B are the same sign.
-    result = uvalue + that.uvalue;
-    neg = is_negative;
+    uvalue += that_uvalue;
   }
-  else {
+  else if(that_uvalue < uvalue) {
     //case 2: A + B where either A or B is negative.
-    bool this_greater = uvalue > that.uvalue; //true if A > B.
-    //making sure that mag(left hand operand) > mag(right hand operand)
-    //when doing ubigint subtraction
-    result = this_greater ? uvalue - that.uvalue
-                                 : that.uvalue - uvalue;
     //if mag(left hand operand) > mag(right hand operand),
     //then sign(result) = sign(left hand operator)
+    uvalue -= that_uvalue;
+  }
+  else {
     //and vice-versa
-    neg = this_greater ? is_negative : that.is_negative;
+    uvalue.subtract_from (that_uvalue);
+    is_negative = that.is_negative;
   }
-  return bigint(result, neg);
+  demote();
+  return *this;
 }
 
-bigint bigint::operator- (const bigint& that) const {
-   ubigint result;
-   bool neg = false;
+bigint& bigint::operator-= (const bigint& that) {
+   if (is_small and that.is_small) {
+      unsigned long sum;
+      if (is_negative == that.is_negative) {
+         if (that.small_value < small_value) {
+            small_value -= that.small_value;
+         }else {
+            small_value = that.small_value - small_value;
+            is_negative = small_value == 0 ? false : !that.is_negative;
+         }
+         return *this;
+      }
+      if (not __builtin_add_overflow (small_value, that.small_value,
+                                      &sum)) {
+         small_value = sum;
+         return *this;
+      }
+   }
+   ubigint scratch;
+   const ubigint& that_uvalue = that.magnitude (scratch);
+   promote();
    if(is_negative == that.is_negative) {
      //case 1: A - B where A and B are the same sign.
-     bool this_greater = that.uvalue < uvalue;
-     if(this_greater) {
+     bool that_negative = that.is_negative; //that may be this
+     if(that_uvalue < uvalue) {
        //if mag(A) > mag(B), then abs(A - B) > 0
-       result = uvalue - that.uvalue;
-       neg = is_negative;
+       uvalue -= that_uvalue;
      }
      else { //mag(B) > mag(A)
        //if mag_A < mag_B, then abs(A - B) < 0
-       result = that.uvalue - uvalue;
-       neg = result == 0 ? false : !that.is_negative;
+       uvalue.subtract_from (that_uvalue);
+       is_negative = uvalue == ubigint() ? false : !that_negative;
      }
    }
    else {
        //case 2: A - B where A and B are not the same sign.
-       result = uvalue + that.uvalue;
+       uvalue += that_uvalue;
        //since A and B are not the same sign, if A < 0, then B > 0,
        //which means A - B = -(abs(A) + B)
        //and vice-versa which means A - B = A - (-B) = A + B
-       neg = is_negative;
-     }
-     return bigint(result, neg);
-  }
-
-  bigint bigint::operator* (const bigint& that) const {
-     bigint result;
-     //sign(C) = sign(A) xor sign(B)
-     result.is_negative = !(is_negative == that.is_negative);
-     result.uvalue = uvalue * that.uvalue;
-     return result;
-  }
+   }
+   demote();
+   return *this;
+}
 
-  bigint bigint::operator/ (const bigint& that) const {
-     bigint result;
-     result.is_negative = !(is_negative == that.is_negative);
-     result.uvalue = uvalue / that.uvalue;
-     return result;
-  }
+bigint& bigint::operator*= (const bigint& that) {
+   //sign(C) = sign(A) xor sign(B)
+   bool negative = !(is_negative == that.is_negative);
+   unsigned long product;
+   if (is_small and that.is_small
+       and not __builtin_mul_overflow (small_value, that.small_value,
+                                       &product)) {
+      small_value = product;
+   }else {
+      ubigint scratch;
+      const ubigint& that_uvalue = that.magnitude (scratch);
+      promote();
+      uvalue *= that_uvalue;
+      demote();
+   }
+   is_negative = negative;
+   return *this;
+}
 
-  bigint bigint::operator% (const bigint& that) const {
-     bigint result;
-     result.is_negative = false; //remainder can't be negative
-     result.uvalue = uvalue % that.uvalue;
-     return result;
-  }
+bigint& bigint::operator/= (const bigint& that) {
+   bool negative = !(is_negative == that.is_negative);
+   if (is_small and that.is_small) {
+      if (that.small_value == 0) throw domain_error ("udivide by zero");
+      small_value /= that.small_value;
+   }else {
+      ubigint scratch;
+      const ubigint& that_uvalue = that.magnitude (scratch);
+      promote();
+      uvalue /= that_uvalue;
+      demote();
+   }
+   is_negative = negative;
+   return *this;
+}
 
-  bool bigint::operator== (const bigint& that) const {
-     return is_negative == that.is_negative and uvalue == that.uvalue;
-  }
+bigint& bigint::operator%= (const bigint& that) {
+   if (is_small and that.is_small) {
+      if (that.small_value == 0) throw domain_error ("udivide by zero");
+      small_value %= that.small_value;
+   }else {
+      ubigint scratch;
+      const ubigint& that_uvalue = that.magnitude (scratch);
+      promote();
+      uvalue %= that_uvalue;
+      demote();
+   }
+   is_negative = false; //remainder can't be negative
+   return *this;
+}
 
-  bool bigint::operator< (const bigint& that) const {
-     if (is_negative != that.is_negative) return is_negative;
-     return is_negative ? uvalue > that.uvalue
-                        : uvalue < that.uvalue;
-  }
+//shifts act on the magnitude, so >>= truncates toward zero
+//like operator/ does
+bigint& bigint::operator<<= (size_t bits) {
+   constexpr size_t SMALL_BITS = numeric_limits<unsigned long>::digits;
+   if (is_small and (small_value == 0 or (bits < SMALL_BITS
+       and (small_value >> (SMALL_BITS - 1 - bits) >> 1) == 0))) {
+      if (small_value != 0) small_value <<= bits;
+      return *this;
+   }
+   promote();
+   uvalue <<= bits;
+   return *this;
+}
 
-  ostream& operator<< (ostream& out, const bigint& that) {
-     //output to out: bigint(+/-, mag_A)
-     return out << (that.is_negative ? "-" : "")
-                << that.uvalue;
-  }
+bigint& bigint::operator>>= (size_t bits) {
+   constexpr size_t SMALL_BITS = numeric_limits<unsigned long>::digits;
+   if (is_small) {
+      small_value = bits < SMALL_BITS ? small_value >> bits : 0;
+      return *this;
+   }
+   uvalue >>= bits;
+   demote();
+   return *this;
+}
+
+bool bigint::is_odd() const {
+   return is_small ? (small_value & 1) != 0 : uvalue.is_odd();
+}
+
+size_t bigint::bit_length() const {
+   if (not is_small) return uvalue.bit_length();
+   if (small_value == 0) return 0;
+   return numeric_limits<unsigned long>::digits
+        - __builtin_clzl (small_value);
+}
+
+//a value held in uvalue never fits, since it would have been
+//moved inline; -0 counts as 0
+bool bigint::to_ulong (unsigned long& value) const {
+   if (not is_small or (is_negative and small_value != 0)) return false;
+   value = small_value;
+   return true;
+}
+
+//Values are demoted whenever they fit, so an inline magnitude is
+//always smaller than one held in limbs.
+bool bigint::operator== (const bigint& that) const {
+   if (is_negative != that.is_negative) return false;
+   if (is_small != that.is_small) return false;
+   return is_small ? small_value == that.small_value
+                   : uvalue == that.uvalue;
+}
+
+bool bigint::operator< (const bigint& that) const {
+   if (is_negative != that.is_negative) return is_negative;
+   const bigint& lesser = is_negative ? that : *this;
+   const bigint& greater = is_negative ? *this : that;
+   if (lesser.is_small != greater.is_small) return lesser.is_small;
+   return lesser.is_small ? lesser.small_value < greater.small_value
+                          : lesser.uvalue < greater.uvalue;
+}
+
+//append the sign and digits to out; an inline magnitude is at most
+//20 digits, so it never needs a line break, and a fraction is rare
+//enough to go the long way
+void bigint::print (string& out, size_t scale) const {
+   if (is_negative) out += '-';
+   if (not is_small) {
+      uvalue.print (out, scale);
+      return;
+   }
+   if (scale > 0) {
+      ubigint (small_value).print (out, scale);
+      return;
+   }
+   char digits[numeric_limits<unsigned long>::digits10 + 1];
+   char* last = to_chars (begin (digits), end (digits),
+                          small_value).ptr;
+   out.append (digits, last);
+}
+
+ostream& operator<< (ostream& out, const bigint& that) {
+   //output to out: bigint(+/-, mag_A)
+   string text;
+   that.print (text);
+   return out << text;
+}
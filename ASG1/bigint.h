@@ -7,6 +7,7 @@
 #include <exception>
 #include <iostream>
 #include <limits>
+#include <string_view>
 #include <utility>
 using namespace std;
 
@@ -18,15 +19,26 @@ using namespace std;
 //Big Integer Class Definition
 class bigint {
    friend ostream& operator<< (ostream&, const bigint&);
+   friend bigint pow (const bigint&, const bigint&);
+   friend bigint powmod (const bigint&, const bigint&, const bigint&);
    private:
-      ubigint uvalue; //magnitude of bigint
+      //Magnitudes that fit in an unsigned long are kept inline in
+      //small_value and uvalue stays empty, so most values never
+      //touch the heap.  Larger magnitudes live in uvalue.  Results
+      //are moved back inline as soon as they fit, so each value has
+      //exactly one representation.
+      ubigint uvalue; //magnitude of bigint when not is_small
+      unsigned long small_value {0}; //magnitude when is_small
+      bool is_small {true};
       bool is_negative {false}; //sign of bigint
+      void promote();
+      void demote();
    public:
 
       bigint() = default; // Needed or will be suppressed.
       bigint (long);
       bigint (const ubigint&, bool is_negative = false);
-      explicit bigint (const string&);
+      explicit bigint (string_view);
 
       bigint operator+() const;
       bigint operator-() const;
@@ -36,7 +48,32 @@ class bigint {
       bigint operator* (const bigint&) const;
       bigint operator/ (const bigint&) const;
       bigint operator% (const bigint&) const;
+      bigint operator<< (size_t) const;
+      bigint operator>> (size_t) const;
 
+      //in place forms; the right operand may be this
+      bigint& operator+= (const bigint&);
+      bigint& operator-= (const bigint&);
+      bigint& operator*= (const bigint&);
+      bigint& operator/= (const bigint&);
+      bigint& operator%= (const bigint&);
+      bigint& operator<<= (size_t);
+      bigint& operator>>= (size_t);
+
+      //append the sign and digits, as operator<< writes them, with
+      //a decimal point before the last scale digits
+      void print (string& out, size_t scale = 0) const;
+
+      //the sign, which -0 has too, and the magnitude, built in
+      //scratch if it is held inline
+      bool negative() const { return is_negative; }
+      const ubigint& magnitude (ubigint& scratch) const;
+
+      bool is_odd() const;
+      //bits in the magnitude, up to and including the highest set one
+      size_t bit_length() const;
+      //true, with value set, if this is not negative and fits
+      bool to_ulong (unsigned long& value) const;
       bool operator== (const bigint&) const;
       bool operator<  (const bigint&) const;
 };
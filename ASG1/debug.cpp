@@ -4,6 +4,7 @@
 
 #include <climits>
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 using namespace std;
@@ -13,10 +14,18 @@ using namespace std;
 
 debugflags::flagset debugflags::flags {};
 
+//one trace at a time, so that a trace's lines stay together
+static mutex trace_lock;
+
 void debugflags::setflags (const string& initflags) {
    for (const unsigned char flag: initflags) {
-      if (flag == '@') flags.set();
-                  else flags.set (flag, true);
+      if (flag == '@') {
+         for (atomic<bool>& each: flags) {
+            each.store (true, memory_order_relaxed);
+         }
+      }else {
+         flags[flag].store (true, memory_order_relaxed);
+      }
    }
 }
 
@@ -25,12 +34,27 @@ void debugflags::setflags (const string& initflags) {
 
 bool debugflags::getflag (char flag) {
    // WARNING: Don't TRACE this function or the stack will blow up.
-   return flags.test (static_cast<unsigned char> (flag));
+   return flags[static_cast<unsigned char> (flag)]
+          .load (memory_order_relaxed);
 }
 
-void debugflags::where (char flag, const char* file, int line,
-                        const char* pretty_function) {
+static void write_where (char flag, const char* file, int line,
+                         const char* pretty_function) {
    cout << exec::execname() << ": DEBUG(" << flag << ") "
         << file << "[" << line << "] " << endl
         << "   " << pretty_function << endl;
 }
+
+void debugflags::where (char flag, const char* file, int line,
+                        const char* pretty_function) {
+   lock_guard<mutex> guard (trace_lock);
+   write_where (flag, file, line, pretty_function);
+}
+
+void debugflags::trace (char flag, const char* file, int line,
+                        const char* pretty_function,
+                        const string& message) {
+   lock_guard<mutex> guard (trace_lock);
+   write_where (flag, file, line, pretty_function);
+   cerr << message << endl;
+}
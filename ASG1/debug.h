@@ -4,8 +4,11 @@
 #ifndef __DEBUG_H__
 #define __DEBUG_H__
 
-#include <bitset>
+#include <array>
+#include <atomic>
 #include <climits>
+#include <iostream>
+#include <sstream>
 #include <string>
 using namespace std;
 
@@ -17,16 +20,23 @@ using namespace std;
 // getflag -
 //    Used by the DEBUGF macro to check to see if a flag has been set.
 //    Not to be called by user code.
+// trace -
+//    Used by the DEBUGF macro to write a trace.  Flags may be tested
+//    and traces written from any thread; each trace is written
+//    whole, so traces from different threads do not interleave.
 
 class debugflags {
    private:
-      using flagset = bitset<UCHAR_MAX + 1>;
+      using flagset = array<atomic<bool>, UCHAR_MAX + 1>;
       static flagset flags;
    public:
       static void setflags (const string& optflags);
       static bool getflag (char flag);
       static void where (char flag, const char* file, int line,
                          const char* pretty_function);
+      static void trace (char flag, const char* file, int line,
+                         const char* pretty_function,
+                         const string& message);
 };
 
 
@@ -45,9 +55,11 @@ class debugflags {
 #else
 #define DEBUGF(FLAG,CODE) { \
            if (debugflags::getflag (FLAG)) { \
-              debugflags::where (FLAG, __FILE__, __LINE__, \
-                                 __PRETTY_FUNCTION__); \
-              cerr << CODE << endl; \
+              ostringstream trace_message; \
+              trace_message << CODE; \
+              debugflags::trace (FLAG, __FILE__, __LINE__, \
+                                 __PRETTY_FUNCTION__, \
+                                 trace_message.str()); \
            } \
         }
 #define DEBUGS(FLAG,STMT) { \
@@ -0,0 +1,369 @@
+// $Id: divide.cpp,v 1.1 2020-02-03 16:22:05-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+using namespace std;
+
+#include "divide.h"
+#include "multiply.h"
+#include "stats.h"
+
+size_t div_thresholds::burnikel_ziegler = 80;
+size_t div_thresholds::newton = 3000;
+size_t div_thresholds::newton_balanced = 28000;
+
+//reciprocals this short are found by dividing outright
+static constexpr size_t NEWTON_BASE = 32;
+
+//below 4 limbs a halved block would drop under the 2 limbs
+//that Algorithm D needs
+static size_t bz_threshold() {
+   return max<size_t> (div_thresholds::burnikel_ziegler, 4);
+}
+
+static int leading_zeros (limb_t limb) {
+   return __builtin_clz (limb);
+}
+
+void divide_knuth (limb_t* q, limb_t* r, const limb_t* u, size_t un,
+                   const limb_t* v, size_t vn) {
+   const dlimb_t base = dlimb_t (1) << LIMB_BITS;
+   //normalize so that the top bit of the divisor is set, which keeps
+   //each estimated quotient limb within 2 of the true one
+   int shift = leading_zeros (v[vn - 1]);
+   limbvec vnorm (vn);
+   lshift (vnorm.data(), v, vn, shift);
+   limbvec unorm (un + 1);
+   unorm[un] = lshift (unorm.data(), u, un, shift);
+   const limb_t vtop = vnorm[vn - 1];
+   const limb_t vnext = vnorm[vn - 2];
+
+   for (size_t jiter = un - vn + 1; jiter-- > 0;) {
+      limb_t* window = unorm.data() + jiter;
+      dlimb_t numerator = static_cast<dlimb_t>(window[vn]) << LIMB_BITS
+                        | window[vn - 1];
+      dlimb_t qhat = numerator / vtop;
+      dlimb_t rhat = numerator % vtop;
+      while (qhat >= base
+             or qhat * vnext > ((rhat << LIMB_BITS) | window[vn - 2])) {
+         --qhat;
+         rhat += vtop;
+         if (rhat >= base) break;
+      }
+      limb_t borrow = submul_1 (window, vnorm.data(), vn,
+                                static_cast<limb_t>(qhat));
+      if (window[vn] < borrow) {
+         //qhat was one too large, so add one divisor back
+         --qhat;
+         window[vn] += add_n (window, window, vnorm.data(), vn);
+      }
+      window[vn] -= borrow;
+      q[jiter] = static_cast<limb_t>(qhat);
+   }
+   rshift (r, unorm.data(), vn, shift);
+}
+
+static void bz_divide_3h_2h (limb_t* q, limb_t* r, const limb_t* a,
+                             const limb_t* b, size_t h);
+
+//
+// bz_divide_2n_1n -
+//    q[0..n) and r[0..n) from a[0..2n) / b[0..n), where the top bit
+//    of b is set and a[n..2n) < b.  Splits into two 3h by 2h
+//    divisions when n is even and large enough.
+//
+
+static void bz_divide_2n_1n (limb_t* q, limb_t* r, const limb_t* a,
+                             const limb_t* b, size_t n) {
+   if (n % 2 != 0 or n < bz_threshold()) {
+      limbvec quotient (n + 1);
+      divide_knuth (quotient.data(), r, a, 2 * n, b, n);
+      copy_n (quotient.data(), n, q);
+      return;
+   }
+   size_t h = n / 2;
+   limbvec upper (n);
+   bz_divide_3h_2h (q + h, upper.data(), a + h, b, h);
+   limbvec lower (3 * h);
+   copy_n (a, h, lower.data());
+   copy_n (upper.data(), n, lower.data() + h);
+   bz_divide_3h_2h (q, r, lower.data(), b, h);
+}
+
+//
+// bz_divide_3h_2h -
+//    q[0..h) and r[0..2h) from a[0..3h) / b[0..2h), where the top
+//    bit of b is set and a[h..3h) < b.  The quotient is estimated
+//    from the top halves and corrected at most twice.
+//
+
+static void bz_divide_3h_2h (limb_t* q, limb_t* r, const limb_t* a,
+                             const limb_t* b, size_t h) {
+   const limb_t* b_low = b;
+   const limb_t* b_high = b + h;
+   const limb_t* a_high = a + 2 * h;
+
+   //estimate = [a1 a2] / b1, remainder held in the top of estimate
+   limbvec estimate (2 * h + 1, 0);
+   if (cmp_n (a_high, b_high, h) < 0) {
+      bz_divide_2n_1n (q, estimate.data() + h, a + h, b_high, h);
+   }else {
+      //a1 == b1, so the quotient is beta^h - 1 and the remainder
+      //is [a2 a1] - [0 b1] + b1 = a2 + b1
+      fill_n (q, h, ~limb_t (0));
+      estimate[2 * h] = add_n (estimate.data() + h, a + h, b_high, h);
+   }
+   copy_n (a, h, estimate.data());
+
+   limbvec product (2 * h + 1, 0);
+   multiply (product.data(), q, h, b_low, h);
+
+   while (cmp_n (estimate.data(), product.data(), 2 * h + 1) < 0) {
+      sub_1 (q, h, 1);
+      estimate[2 * h] += add_n (estimate.data(), estimate.data(),
+                                b, 2 * h);
+   }
+   sub_n (r, estimate.data(), product.data(), 2 * h);
+}
+
+//
+// divide_bz -
+//    Pad the divisor to a block size of the form j * 2^k limbs with
+//    j below the threshold, shift both operands so the top bit of
+//    the divisor is set, and divide the dividend a block at a time
+//    from the top.
+//
+
+static void divide_bz (limbvec& quotient, limbvec& remainder,
+                       const limbvec& dividend,
+                       const limbvec& divisor) {
+   size_t vn = divisor.size();
+   size_t block = vn;
+   int levels = 0;
+   while (block >= bz_threshold()) {
+      block = (block + 1) / 2;
+      ++levels;
+   }
+   block <<= levels;
+   size_t pad = block - vn;
+   int shift = leading_zeros (divisor.back());
+
+   limbvec b (block, 0);
+   lshift (b.data() + pad, divisor.data(), vn, shift);
+
+   limbvec a (pad + dividend.size() + 1, 0);
+   a.back() = lshift (a.data() + pad, dividend.data(),
+                      dividend.size(), shift);
+   //the top block must be below b, so add a zero block if it is not
+   size_t used = normalized_size (a.data(), a.size());
+   size_t blocks = max<size_t> (2, (used + block - 1) / block);
+   a.resize (blocks * block, 0);
+   if (cmp_n (a.data() + (blocks - 1) * block, b.data(), block) >= 0) {
+      a.resize (++blocks * block, 0);
+   }
+
+   quotient.assign ((blocks - 1) * block, 0);
+   limbvec window (a.end() - 2 * block, a.end());
+   limbvec rest (block);
+   for (size_t iter = blocks - 1; iter-- > 0;) {
+      bz_divide_2n_1n (quotient.data() + iter * block, rest.data(),
+                       window.data(), b.data(), block);
+      if (iter > 0) {
+         copy_n (a.data() + (iter - 1) * block, block, window.data());
+      }
+      copy_n (rest.data(), block, window.data() + block);
+   }
+   quotient.resize (normalized_size (quotient.data(), quotient.size()));
+   remainder.resize (vn);
+   rshift (rest.data(), rest.data(), block, shift);
+   copy_n (rest.data() + pad, vn, remainder.data());
+   remainder.resize (normalized_size (remainder.data(), vn));
+}
+
+//every tier but Newton's, which needs this for its base case
+static void divide_classic (limbvec& quotient, limbvec& remainder,
+                            const limbvec& dividend,
+                            const limbvec& divisor) {
+   if (dividend.size() < divisor.size()) {
+      quotient.clear();
+      remainder = dividend;
+      return;
+   }
+   if (divisor.size() == 1) {
+      stats::count_tier (tier::DIV_SINGLE);
+      quotient.resize (dividend.size());
+      limb_t rem = divrem_1 (quotient.data(), dividend.data(),
+                             dividend.size(), divisor[0]);
+      quotient.resize (normalized_size (quotient.data(),
+                                        quotient.size()));
+      remainder.assign (rem != 0, rem);
+      return;
+   }
+   if (divisor.size() >= bz_threshold()
+       and dividend.size() - divisor.size() >= bz_threshold()) {
+      stats::count_tier (tier::DIV_BURNIKEL_ZIEGLER);
+      divide_bz (quotient, remainder, dividend, divisor);
+      return;
+   }
+   stats::count_tier (tier::DIV_KNUTH);
+   quotient.resize (dividend.size() - divisor.size() + 1);
+   remainder.resize (divisor.size());
+   divide_knuth (quotient.data(), remainder.data(), dividend.data(),
+                 dividend.size(), divisor.data(), divisor.size());
+   quotient.resize (normalized_size (quotient.data(), quotient.size()));
+   remainder.resize (normalized_size (remainder.data(),
+                                      remainder.size()));
+}
+
+
+//
+// reciprocal -
+//    x[0..k+1) close to (beta^2k - 1) / v[0..k), where the top bit
+//    of v is set, so that beta^k <= x < 2 beta^k.  x is first found
+//    to half precision from the top h limbs of v, and then one
+//    Newton step, x + x (beta^2k - v x) / beta^2k, doubles that.
+//    Truncation leaves x off by a few units either way, which the
+//    caller corrects for.
+//
+
+static limbvec reciprocal (const limb_t* v, size_t k) {
+   if (k <= NEWTON_BASE) {
+      limbvec ones (2 * k, ~limb_t (0));
+      limbvec x, rest;
+      divide_classic (x, rest, ones, limbvec (v, v + k));
+      x.resize (k + 1, 0);
+      return x;
+   }
+   size_t h = k / 2 + 2;
+   limbvec xh = reciprocal (v + k - h, h);
+
+   //v xh is near beta^(k+h), and e = beta^(k+h) - v xh is the error
+   //in units of beta^(k-h)
+   limbvec error (k + h + 1);
+   multiply (error.data(), v, k, xh.data(), h + 1);
+   bool low = error[k + h] == 0;
+   if (low) {
+      //e = beta^(k+h) - p, i.e. the two's complement of p
+      for (size_t index = 0; index < k + h; ++index) {
+         error[index] = ~error[index];
+      }
+      add_1 (error.data(), k + h, 1);
+   }else {
+      --error[k + h];
+   }
+   size_t en = normalized_size (error.data(), error.size());
+
+   //x = xh beta^(k-h) +/- xh e / beta^2h, where the low h - 2 limbs
+   //of e change the step by less than a unit, so they are dropped
+   limbvec x (k + 1, 0);
+   copy_n (xh.data(), h + 1, x.data() + k - h);
+   size_t drop = h - 2;
+   if (en <= drop) return x;
+   limbvec step (h + 1 + en - drop);
+   multiply (step.data(), xh.data(), h + 1, error.data() + drop,
+             en - drop);
+   size_t skip = 2 * h - drop;
+   if (step.size() <= skip) return x;
+   const limb_t* shifted = step.data() + skip;
+   size_t sn = min (step.size() - skip, k + 1);
+   if (low) {
+      add (x.data(), x.data(), k + 1, shifted, sn);
+   }else {
+      sub (x.data(), x.data(), k + 1, shifted, sn);
+   }
+   return x;
+}
+
+//-1, 0 or 1 as normalized a is less than, equal to or greater than b
+static int compare (const limbvec& a, const limbvec& b) {
+   if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+   return cmp_n (a.data(), b.data(), a.size());
+}
+
+//a -= b for normalized a >= b, leaving a normalized
+static void subtract (limbvec& a, const limbvec& b) {
+   sub (a.data(), a.data(), a.size(), b.data(), b.size());
+   a.resize (normalized_size (a.data(), a.size()));
+}
+
+//
+// divide_newton -
+//    Multiply the top of the dividend by a reciprocal of the top of
+//    the divisor, both kept to about as many limbs as the quotient
+//    has, so the division costs a few multiplications.  The
+//    estimate is within a few units of the quotient, and is fixed
+//    up by comparing its product with the dividend.
+//
+
+static void divide_newton (limbvec& quotient, limbvec& remainder,
+                           const limbvec& dividend,
+                           const limbvec& divisor) {
+   int shift = leading_zeros (divisor.back());
+   size_t vn = divisor.size();
+   limbvec v (vn);
+   lshift (v.data(), divisor.data(), vn, shift);
+   size_t un = dividend.size() + 1;
+   limbvec u (un);
+   u.back() = lshift (u.data(), dividend.data(), dividend.size(),
+                      shift);
+
+   //the quotient has at most n limbs, so only the top k = n + 2
+   //limbs of each operand matter to the estimate; a shorter
+   //divisor is padded with zero limbs below to that precision
+   size_t n = un - vn + 1;
+   size_t k = n + 2;
+   size_t m = min (k, un);
+   limbvec top (k, 0);
+   size_t used = min (vn, k);
+   copy_n (v.data() + vn - used, used, top.data() + k - used);
+   limbvec x = reciprocal (top.data(), k);
+   limbvec estimate (m + k + 1);
+   multiply (estimate.data(), u.data() + un - m, m, x.data(), k + 1);
+   quotient.assign (estimate.begin() + k + m + vn - un, estimate.end());
+   quotient.resize (normalized_size (quotient.data(), quotient.size()));
+   u.resize (normalized_size (u.data(), un));
+
+   limbvec product;
+   if (not quotient.empty()) multiply (product, quotient, v);
+   while (compare (product, u) > 0) {
+      sub_1 (quotient.data(), quotient.size(), 1);
+      quotient.resize (normalized_size (quotient.data(),
+                                        quotient.size()));
+      subtract (product, v);
+   }
+   subtract (u, product);
+   while (compare (u, v) >= 0) {
+      quotient.push_back (0);
+      add_1 (quotient.data(), quotient.size(), 1);
+      quotient.resize (normalized_size (quotient.data(),
+                                        quotient.size()));
+      subtract (u, v);
+   }
+   remainder.resize (u.size());
+   if (not u.empty()) {
+      rshift (remainder.data(), u.data(), u.size(), shift);
+   }
+   remainder.resize (normalized_size (remainder.data(),
+                                      remainder.size()));
+}
+
+//Newton's method for a quotient short beside the divisor, or for
+//a long divisor and a quotient of about its length
+static bool use_newton (size_t dividend, size_t divisor) {
+   if (dividend < divisor) return false;
+   size_t quotient = dividend - divisor + 1;
+   if (divisor >= div_thresholds::newton
+       and quotient <= divisor / 2) return true;
+   return divisor >= div_thresholds::newton_balanced
+      and quotient <= 2 * divisor;
+}
+
+void divide (limbvec& quotient, limbvec& remainder,
+             const limbvec& dividend, const limbvec& divisor) {
+   if (use_newton (dividend.size(), divisor.size())) {
+      stats::count_tier (tier::DIV_NEWTON);
+      divide_newton (quotient, remainder, dividend, divisor);
+   }else {
+      divide_classic (quotient, remainder, dividend, divisor);
+   }
+}
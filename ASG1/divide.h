@@ -0,0 +1,48 @@
+// $Id: divide.h,v 1.1 2020-02-03 16:22:05-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// divide -
+//    Limb division.  Single limb divisors use short division,
+//    divisors shorter than burnikel_ziegler limbs use Knuth's
+//    Algorithm D, and longer ones use Burnikel and Ziegler's
+//    recursive division, which reduces the work to multiplications
+//    so it runs at the speed of the multiply tiers.  Newton's
+//    method instead finds a reciprocal as long as the quotient and
+//    makes the quotient one multiplication by it, which saves the
+//    log factor that the recursion costs, and only needs the top of
+//    a divisor longer than the quotient, where the recursion works
+//    through all of it.  So it is used when the divisor has at
+//    least newton limbs and is at least twice as long as the
+//    quotient, or has at least newton_balanced limbs and the
+//    quotient is at most twice as long as it.  A quotient much
+//    longer than the divisor is left to the recursion, which
+//    divides it a divisor's length at a time.
+//
+
+#ifndef __DIVIDE_H__
+#define __DIVIDE_H__
+
+#include "limbs.h"
+
+class div_thresholds {
+   public:
+      static size_t burnikel_ziegler;
+      static size_t newton;
+      static size_t newton_balanced;
+};
+
+// divide_knuth -
+//    q[0..un-vn+1) = u[0..un) / v[0..vn), r[0..vn) = remainder.
+//    Requires un >= vn >= 2 and v[vn-1] != 0.  q and r must not
+//    alias anything.
+void divide_knuth (limb_t* q, limb_t* r, const limb_t* u, size_t un,
+                   const limb_t* v, size_t vn);
+
+// divide -
+//    Normalized quotient and remainder of two normalized limb
+//    vectors.  The divisor must not be empty.
+void divide (limbvec& quotient, limbvec& remainder,
+             const limbvec& dividend, const limbvec& divisor);
+
+#endif
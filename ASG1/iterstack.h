@@ -42,6 +42,7 @@ class iterstack {
       void push (const value_type& value) { stack.push_back (value); }
       void pop() { stack.pop_back(); }
       const value_type& top() const { return stack.back(); }
+      value_type& top() { return stack.back(); }
 };
 
 #endif
@@ -1,34 +1,602 @@
 // $Id: libfns.cpp,v 1.1 2019-12-12 18:19:23-08 - - $
 // Sasank Madineni (smadinen)
 // Perry Ralston (pdralsto)
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+using namespace std;
+
 #include "libfns.h"
+
 //
-// This algorithm would be more efficient with operators
-// *=, /=2, and is_odd.  But we leave it here.
+// Powers of two are a shift, and powers of 10^j come from the cache
+// that upow10 shares with the radix converter.  Other small powers
+// are squared and multiplied in machine words while they fit, and
+// the rest go to upow, which reads the exponent's bits left to
+// right in sliding windows.  An exponent that does not fit in an
+// unsigned long is only usable with a base of magnitude 0 or 1,
+// since any other power would not fit in memory.
 //
 
-bigint pow (const bigint& base_arg, const bigint& exponent_arg) {
-   bigint base (base_arg);
-   bigint exponent (exponent_arg);
+static bool ulong_pow (unsigned long base, unsigned long exponent,
+                       unsigned long& result) {
+   result = 1;
+   for (;;) {
+      if ((exponent & 1) != 0
+          and __builtin_mul_overflow (result, base, &result)) {
+         return false;
+      }
+      exponent >>= 1;
+      if (exponent == 0) return true;
+      if (__builtin_mul_overflow (base, base, &base)) return false;
+   }
+}
+
+//j if value is 10^j for some j > 0, else 0
+static unsigned long decimal_exponent (unsigned long value) {
+   unsigned long exponent = 0;
+   while (value >= 10 and value % 10 == 0) {
+      value /= 10;
+      ++exponent;
+   }
+   return value == 1 ? exponent : 0;
+}
+
+bigint pow (const bigint& base, const bigint& exponent) {
    static const bigint ZERO (0);
    static const bigint ONE (1);
-   static const bigint TWO (2);
    DEBUGF ('^', "base = " << base << ", exponent = " << exponent);
    if (base == ZERO) return ZERO;
-   bigint result = ONE;
-   if (exponent < ZERO) {
-      base = ONE / base;
-      exponent = - exponent;
-   }
-   while (exponent > ZERO) {
-      if (exponent % TWO == ONE) {
-         result = result * base;
-         exponent = exponent - 1;
-      }else {
-         base = base * base;
-         exponent = exponent / 2;
+   unsigned long times = 0;
+   if (not exponent.to_ulong (times)) {
+      if (exponent < ZERO) return pow (ONE / base, -exponent);
+      if (base.bit_length() > 1) {
+         throw domain_error ("exponent too large");
       }
+      return base.is_negative and exponent.is_odd() ? -ONE : ONE;
+   }
+   bool negative = base.is_negative and (times & 1) != 0;
+   bigint result;
+   unsigned long value = base.small_value;
+   unsigned long scaled = 0;
+   if (base.bit_length() == 0) {
+      //-0, which takes the sign of its power like any negative base
+      result = times == 0 ? ONE : ZERO;
+   }else if (not base.is_small) {
+      ubigint scratch;
+      result = bigint (upow (base.magnitude (scratch), times));
+   }else if ((value & (value - 1)) == 0
+             and not __builtin_mul_overflow (base.bit_length() - 1,
+                                             times, &scaled)) {
+      result = ONE << scaled;
+   }else if (not __builtin_mul_overflow (decimal_exponent (value),
+                                         times, &scaled)
+             and scaled != 0) {
+      result = bigint (upow10 (scaled));
+   }else if (ulong_pow (value, times, scaled)) {
+      result = bigint (ubigint (scaled));
+   }else {
+      result = bigint (upow (ubigint (value), times));
    }
+   if (negative) result = -result;
    DEBUGF ('^', "result = " << result);
    return result;
 }
+
+//
+// Always multiplying the two shortest factors left keeps every
+// multiply between numbers of about the same length, like a
+// balanced product tree, even when the lengths are uneven, so the
+// fast multiply tiers do the work.  n short factors of N bits in all
+// cost about M(N) log n, where multiplying them one at a time into
+// an accumulator costs N^2.
+//
+
+bigint product (vector<bigint> factors) {
+   static const bigint ONE (1);
+   if (factors.empty()) return ONE;
+   auto longer = [] (const bigint& left, const bigint& right) {
+      return left.bit_length() > right.bit_length();
+   };
+   priority_queue<bigint, vector<bigint>, decltype (longer)>
+         shortest (longer, move (factors));
+   DEBUGF ('*', shortest.size() << " factors");
+   while (shortest.size() > 1) {
+      bigint left = shortest.top();
+      shortest.pop();
+      bigint right = shortest.top();
+      shortest.pop();
+      shortest.push (left * right);
+   }
+   return shortest.top();
+}
+
+//
+// Same value as pow (base, exponent) % modulus, but reduced after
+// every multiply so that nothing grows past the size of the modulus.
+// Like %, the result takes the magnitudes of its operands and is
+// never negative.  A negative exponent or a zero base takes pow's
+// path, since pow's answer there is already 0 or 1.
+//
+
+bigint powmod (const bigint& base, const bigint& exponent,
+               const bigint& modulus) {
+   static const bigint ZERO (0);
+   DEBUGF ('^', "base = " << base << ", exponent = " << exponent
+                << ", modulus = " << modulus);
+   if (exponent < ZERO or base == ZERO) {
+      return pow (base, exponent) % modulus;
+   }
+   ubigint base_scratch, exponent_scratch, modulus_scratch;
+   bigint result (upowmod (base.magnitude (base_scratch),
+                           exponent.magnitude (exponent_scratch),
+                           modulus.magnitude (modulus_scratch)));
+   DEBUGF ('^', "result = " << result);
+   return result;
+}
+
+//
+// Newton's method from above, which stops at the floor of the root
+// as soon as a step fails to go down.  The root of the top half of
+// the bits, found the same way, gives a start good to about half
+// the bits, and each step doubles that, so two or three divisions
+// of the full size finish it.  Each level below costs half as much
+// as the one above it, so the whole is a few full size divisions.
+//
+
+static unsigned long ulong_sqrt (unsigned long number) {
+   auto root = static_cast<unsigned long> (
+               sqrt (static_cast<double> (number)));
+   //the double may be off by one either way
+   while (root > 0 and root > number / root) --root;
+   while (root + 1 <= number / (root + 1)) ++root;
+   return root;
+}
+
+bigint isqrt (const bigint& number) {
+   static const bigint ZERO (0);
+   static const bigint ONE (1);
+   unsigned long small = 0;
+   if (number.to_ulong (small)) {
+      return bigint (static_cast<long> (ulong_sqrt (small)));
+   }
+   if (number < ZERO) {
+      throw domain_error ("square root of negative number");
+   }
+   //(root of the top + 1) << half is above the root of all of it
+   size_t half = number.bit_length() / 4;
+   bigint root = (isqrt (number >> 2 * half) + ONE) << half;
+   for (;;) {
+      bigint next = (root + number / root) >> 1;
+      if (not (next < root)) break;
+      root = move (next);
+   }
+   DEBUGF ('^', "isqrt (" << number << ") = " << root);
+   return root;
+}
+
+//
+// Lehmer's gcd.  Euclid's quotients depend almost only on the
+// leading bits, so Euclid runs on the top 62 bits of a and b in
+// machine words for as long as those decide the quotients, which is
+// checked as in Knuth's Algorithm L, collecting its steps in a 2x2
+// matrix.  The matrix is then applied to a and b in one linear pass,
+// which takes off about 30 bits where a division step takes off a
+// few.  If the leading bits decide nothing, the quotient is large
+// and one division step is taken instead.  The cofactors, if not
+// null, go through the same steps as a and b.  On entry a >= b >= 0,
+// and on return b is 0 and a is the gcd.
+//
+
+static void lehmer (bigint& a, bigint& b,
+                    bigint* a_cofactor, bigint* b_cofactor) {
+   static const bigint ZERO (0);
+   constexpr size_t LEAD_BITS = 62;
+   while (not (b == ZERO)) {
+      size_t length = a.bit_length();
+      size_t shift = length > LEAD_BITS ? length - LEAD_BITS : 0;
+      unsigned long a_lead = 0;
+      unsigned long b_lead = 0;
+      (a >> shift).to_ulong (a_lead);
+      (b >> shift).to_ulong (b_lead);
+      long ahat = a_lead, bhat = b_lead;
+      long A = 1, B = 0, C = 0, D = 1;
+      while (bhat + C != 0 and bhat + D != 0) {
+         long quotient = (ahat + A) / (bhat + C);
+         if (quotient != (ahat + B) / (bhat + D)) break;
+         long next = A - quotient * C; A = C; C = next;
+         next = B - quotient * D; B = D; D = next;
+         next = ahat - quotient * bhat; ahat = bhat; bhat = next;
+      }
+      if (B == 0) {
+         bigint quotient = a / b;
+         bigint remainder = a - quotient * b;
+         a = move (b);
+         b = move (remainder);
+         if (a_cofactor != nullptr) {
+            bigint next = *a_cofactor - quotient * *b_cofactor;
+            *a_cofactor = move (*b_cofactor);
+            *b_cofactor = move (next);
+         }
+      }else {
+         bigint next_a = a * A + b * B;
+         b = a * C + b * D;
+         a = move (next_a);
+         if (a_cofactor != nullptr) {
+            bigint next = *a_cofactor * A + *b_cofactor * B;
+            *b_cofactor = *a_cofactor * C + *b_cofactor * D;
+            *a_cofactor = move (next);
+         }
+      }
+   }
+}
+
+//
+// Half gcd, in Moller's form, for long operands.  Each call takes
+// Euclid steps on a and b, in either order, but only as far as both
+// stay at least 2^s, s being just over half the bits of the longer,
+// and returns the steps as a matrix M of determinant 1 with the old
+// (a, b) = M (new a, new b).  The steps of the top halves of a and b
+// are steps of a and b too as long as the top halves stay above
+// their own bound, which is what the recursive call keeps them at,
+// so the call recurses on the top half, takes one step, recurses on
+// the top of what is left, and finishes with the few steps still
+// possible.  The matrices hold about a quarter of the bits each, so
+// applying them is a multiply of long by short, and the whole costs
+// about M(n) log n against Lehmer's n^2.  Below HALF_GCD_LIMBS limbs
+// the recursion gives way to Lehmer's method, taking the steps of
+// the top word at a time.  gcd and modinv use half gcds while the
+// smaller operand is at least EUCLID_LIMBS long, and then finish
+// with plain Lehmer, which is still the faster of the two below
+// about ten thousand digits.
+//
+
+constexpr size_t HALF_GCD_LIMBS = 60;
+constexpr size_t EUCLID_LIMBS = 1000;
+
+struct gcd_matrix {
+   bigint m00 {1}, m01 {0}, m10 {0}, m11 {1};
+   bool is_identity() const {
+      static const bigint ZERO (0);
+      return m01 == ZERO and m10 == ZERO;
+   }
+   gcd_matrix operator* (const gcd_matrix& that) const {
+      return {m00 * that.m00 + m01 * that.m10,
+              m00 * that.m01 + m01 * that.m11,
+              m10 * that.m00 + m11 * that.m10,
+              m10 * that.m01 + m11 * that.m11};
+   }
+};
+
+//one step that takes as much of the smaller of a and b from the
+//larger as leaves it at least bound, or false if none can
+static bool reduce_step (bigint& a, bigint& b, const bigint& bound,
+                         gcd_matrix& steps) {
+   if (a < bound or b < bound) return false;
+   if (b < a) {
+      if (a - b < bound) return false;
+      bigint quotient = (a - bound) / b;
+      a -= quotient * b;
+      steps.m01 += quotient * steps.m00;
+      steps.m11 += quotient * steps.m10;
+   }else {
+      if (b - a < bound) return false;
+      bigint quotient = (b - bound) / a;
+      b -= quotient * a;
+      steps.m00 += quotient * steps.m01;
+      steps.m10 += quotient * steps.m11;
+   }
+   return true;
+}
+
+//the same steps, all in machine words, when a and b fit in them
+static gcd_matrix word_half_gcd (bigint& a, bigint& b, size_t s) {
+   unsigned long x = 0, y = 0;
+   a.to_ulong (x);
+   b.to_ulong (y);
+   unsigned long bound = 1UL << s;
+   unsigned long m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+   if (x < bound or y < bound) return {};
+   for (;;) {
+      if (y < x) {
+         if (x - y < bound) break;
+         unsigned long quotient = (x - bound) / y;
+         x -= quotient * y;
+         m01 += quotient * m00;
+         m11 += quotient * m10;
+      }else {
+         if (y - x < bound) break;
+         unsigned long quotient = (y - bound) / x;
+         y -= quotient * x;
+         m00 += quotient * m01;
+         m10 += quotient * m11;
+      }
+   }
+   a = bigint (ubigint (x));
+   b = bigint (ubigint (y));
+   return {bigint (ubigint (m00)), bigint (ubigint (m01)),
+           bigint (ubigint (m10)), bigint (ubigint (m11))};
+}
+
+static gcd_matrix half_gcd (bigint& a, bigint& b);
+
+//the steps of a >> shift and b >> shift, applied to a and b, or
+//false if there are none
+static bool reduce_top (bigint& a, bigint& b, size_t shift,
+                        gcd_matrix& steps) {
+   bigint a_top = a >> shift;
+   bigint b_top = b >> shift;
+   bigint a_low = a - (a_top << shift);
+   bigint b_low = b - (b_top << shift);
+   gcd_matrix top = half_gcd (a_top, b_top);
+   if (top.is_identity()) return false;
+   //M^-1 is [[m11, -m01], [-m10, m00]], since det M = 1
+   a = (a_top << shift) + top.m11 * a_low - top.m01 * b_low;
+   b = (b_top << shift) + top.m00 * b_low - top.m10 * a_low;
+   steps = steps * top;
+   return true;
+}
+
+static gcd_matrix half_gcd (bigint& a, bigint& b) {
+   static const bigint ONE (1);
+   size_t length = max (a.bit_length(), b.bit_length());
+   size_t s = length / 2 + 1;
+   constexpr size_t WORD_BITS = numeric_limits<unsigned long>::digits;
+   if (length < WORD_BITS) return word_half_gcd (a, b, s);
+   gcd_matrix steps;
+   bigint bound = ONE << s;
+   if (a < bound or b < bound) return steps;
+   if (length < HALF_GCD_LIMBS * LIMB_BITS) {
+      //Lehmer: the steps of the top word at a time, where the top
+      //is short enough near the end to keep a and b above bound
+      for (;;) {
+         length = max (a.bit_length(), b.bit_length());
+         size_t shift = max (length - (WORD_BITS - 1), 2 * s - length);
+         if (not reduce_top (a, b, shift, steps)
+             and not reduce_step (a, b, bound, steps)) {
+            return steps;
+         }
+      }
+   }
+   reduce_top (a, b, length / 2, steps);
+   if (reduce_step (a, b, bound, steps)) {
+      length = max (a.bit_length(), b.bit_length());
+      reduce_top (a, b, 2 * s - length, steps);
+   }
+   while (reduce_step (a, b, bound, steps)) {}
+   return steps;
+}
+
+//Half gcds while b is long, each about halving it, then Lehmer.  The
+//cofactors, if not null, go through the same steps as a and b.
+static void euclid (bigint& a, bigint& b,
+                    bigint* a_cofactor, bigint* b_cofactor) {
+   while (b.bit_length() >= EUCLID_LIMBS * LIMB_BITS) {
+      gcd_matrix steps = half_gcd (a, b);
+      if (a_cofactor != nullptr and not steps.is_identity()) {
+         bigint next = steps.m11 * *a_cofactor
+                     - steps.m01 * *b_cofactor;
+         *b_cofactor = steps.m00 * *b_cofactor
+                     - steps.m10 * *a_cofactor;
+         *a_cofactor = move (next);
+      }
+      if (a < b) {
+         swap (a, b);
+         if (a_cofactor != nullptr) swap (*a_cofactor, *b_cofactor);
+      }
+      //a and b are now close, or half_gcd could do nothing, and
+      //either way a division step is what comes next
+      bigint quotient = a / b;
+      bigint remainder = a - quotient * b;
+      a = move (b);
+      b = move (remainder);
+      if (a_cofactor != nullptr) {
+         bigint next = *a_cofactor - quotient * *b_cofactor;
+         *a_cofactor = move (*b_cofactor);
+         *b_cofactor = move (next);
+      }
+   }
+   lehmer (a, b, a_cofactor, b_cofactor);
+}
+
+static bigint magnitude (const bigint& value) {
+   static const bigint ZERO (0);
+   return value < ZERO ? -value : value;
+}
+
+bigint gcd (const bigint& left, const bigint& right) {
+   bigint a = magnitude (left);
+   bigint b = magnitude (right);
+   if (a < b) swap (a, b);
+   euclid (a, b, nullptr, nullptr);
+   DEBUGF ('^', "gcd (" << left << ", " << right << ") = " << a);
+   return a;
+}
+
+//
+// Extended Euclid, keeping beside a and b the cofactors that give
+// them as multiples of number modulo the modulus.  When b reaches 0,
+// a is the gcd, and if that is 1 its cofactor is the inverse.
+//
+
+bigint modinv (const bigint& number, const bigint& modulus) {
+   static const bigint ZERO (0);
+   static const bigint ONE (1);
+   bigint a = magnitude (modulus);
+   if (a == ZERO) throw domain_error ("modinv by zero");
+   bigint b = magnitude (number) % a;
+   if (number < ZERO and not (b == ZERO)) b = a - b;
+   bigint a_cofactor = ZERO;
+   bigint b_cofactor = ONE;
+   bigint reduced = a;
+   euclid (a, b, &a_cofactor, &b_cofactor);
+   if (not (a == ONE)) throw domain_error ("not invertible");
+   bigint inverse = magnitude (a_cofactor) % reduced;
+   if (a_cofactor < ZERO and not (inverse == ZERO)) {
+      inverse = reduced - inverse;
+   }
+   DEBUGF ('^', "modinv (" << number << ", " << modulus << ") = "
+                << inverse);
+   return inverse;
+}
+
+//
+// Factorials and binomials are built from their prime factors.  A
+// sieve gives the odd primes up to n, and the power of each prime
+// in the result is counted from the digits of n (and k) in that
+// prime's base, so no big number is ever divided.  The odd factors
+// are packed into machine words while they fit and the words go to
+// product, so the big multiplies are all balanced and fall in the
+// fast tiers.  The powers of two are one shift at the end.
+//
+// Factorials use the prime swing, n! = (n/2)!^2 * swing (n), where
+// the swing n! / (n/2)!^2 has just one factor of each prime above
+// the square root of n, so each level squares the one below it and
+// multiplies in a swing about as long as it is.  A binomial with k
+// much smaller than n is the product of the k factors at the top of
+// n! divided by k!, which spares sieving up to n.
+//
+
+//the sieve is indexed by unsigned long, and primes stored in 32 bits
+constexpr unsigned long SIEVE_LIMIT = UINT32_MAX;
+
+static vector<uint32_t> odd_primes (unsigned long limit) {
+   //composite[i] is for 2i + 1
+   vector<bool> composite (limit / 2 + 1);
+   vector<uint32_t> primes;
+   for (unsigned long index = 1; 2 * index + 1 <= limit; ++index) {
+      if (composite[index]) continue;
+      unsigned long prime = 2 * index + 1;
+      primes.push_back (static_cast<uint32_t> (prime));
+      if (prime > limit / prime) continue;
+      for (unsigned long multiple = prime * prime; multiple <= limit;
+           multiple += 2 * prime) {
+         composite[multiple / 2] = true;
+      }
+   }
+   DEBUGF ('!', primes.size() << " odd primes to " << limit);
+   return primes;
+}
+
+// word_product -
+//    Collects factors of a machine word each, multiplying them
+//    together while the product still fits in a word.
+class word_product {
+   private:
+      vector<bigint> words;
+      unsigned long word {1};
+   public:
+      void times (unsigned long factor) {
+         unsigned long larger = 0;
+         if (not __builtin_mul_overflow (word, factor, &larger)) {
+            word = larger;
+            return;
+         }
+         words.push_back (bigint (ubigint (word)));
+         word = factor;
+      }
+      bigint result() {
+         words.push_back (bigint (ubigint (word)));
+         return product (move (words));
+      }
+};
+
+//the odd part of the swing of n
+static bigint odd_swing (unsigned long n,
+                         const vector<uint32_t>& primes) {
+   word_product factors;
+   for (unsigned long prime: primes) {
+      if (prime > n) break;
+      //the power of prime is the count of odd n / prime^i
+      for (unsigned long quotient = n / prime; quotient > 0;
+           quotient /= prime) {
+         if ((quotient & 1) != 0) factors.times (prime);
+      }
+   }
+   return factors.result();
+}
+
+//the odd part of n!, of which the odd part of (n/2)! is a square
+static bigint odd_factorial (unsigned long n,
+                             const vector<uint32_t>& primes) {
+   static const bigint ONE (1);
+   if (n < 3) return ONE;
+   bigint half = odd_factorial (n / 2, primes);
+   return half * half * odd_swing (n, primes);
+}
+
+bigint factorial (const bigint& number) {
+   static const bigint ZERO (0);
+   if (number < ZERO) {
+      throw domain_error ("factorial of a negative number");
+   }
+   unsigned long n = 0;
+   if (not number.to_ulong (n) or n > SIEVE_LIMIT) {
+      throw domain_error ("factorial argument too large");
+   }
+   bigint result = odd_factorial (n, odd_primes (n));
+   //n! has n - (the count of ones in n) factors of two
+   return result << (n - __builtin_popcountl (n));
+}
+
+//n (n - 1) ... (n - k + 1), the top k factors of n!
+static bigint falling_product (const bigint& number, unsigned long k) {
+   unsigned long n = 0;
+   if (number.to_ulong (n)) {
+      word_product factors;
+      for (unsigned long factor = n - k + 1; factor <= n; ++factor) {
+         factors.times (factor);
+      }
+      return factors.result();
+   }
+   static const bigint ONE (1);
+   vector<bigint> factors;
+   factors.reserve (k);
+   bigint factor = number;
+   for (unsigned long count = 0; count < k; ++count) {
+      factors.push_back (factor);
+      factor = factor - ONE;
+   }
+   return product (move (factors));
+}
+
+bigint binomial (const bigint& number, const bigint& chosen) {
+   static const bigint ZERO (0);
+   static const bigint ONE (1);
+   if (number < ZERO) {
+      throw domain_error ("binomial of a negative number");
+   }
+   if (chosen < ZERO or number < chosen) return ZERO;
+   //n choose k is n choose n - k, so take the smaller
+   bigint rest = number - chosen;
+   unsigned long k = 0;
+   if (not (rest < chosen ? rest : chosen).to_ulong (k)) {
+      throw domain_error ("binomial argument too large");
+   }
+   if (k == 0) return ONE;
+   unsigned long n = 0;
+   if (not number.to_ulong (n) or n > SIEVE_LIMIT or k < n / 32) {
+      bigint top = falling_product (number, k);
+      return top / factorial (bigint (ubigint (k)));
+   }
+   //Kummer: the power of a prime is the count of borrows when k is
+   //taken from n in that prime's base
+   unsigned long twos = __builtin_popcountl (k)
+                      + __builtin_popcountl (n - k)
+                      - __builtin_popcountl (n);
+   word_product factors;
+   for (unsigned long prime: odd_primes (n)) {
+      unsigned long top = n / prime, low = k / prime;
+      unsigned long high = (n - k) / prime;
+      for (; top > 0; top /= prime, low /= prime, high /= prime) {
+         for (unsigned long borrow = top - low - high; borrow > 0;
+              --borrow) {
+            factors.times (prime);
+         }
+      }
+   }
+   return factors.result() << twos;
+}
@@ -3,6 +3,26 @@
 // Perry Ralston (pdralsto)
 // Library functions not members of any class.
 
+#include <vector>
+using namespace std;
+
 #include "bigint.h"
 
 bigint pow (const bigint& base, const bigint& exponent);
+//the product of all the factors, multiplied in a balanced tree
+bigint product (vector<bigint> factors);
+bigint powmod (const bigint& base, const bigint& exponent,
+               const bigint& modulus);
+
+//floor of the square root of a nonnegative value
+bigint isqrt (const bigint& number);
+//greatest common divisor of the magnitudes, gcd (0, 0) being 0
+bigint gcd (const bigint& left, const bigint& right);
+//x in [0, |modulus|) with number * x = 1 mod |modulus|
+bigint modinv (const bigint& number, const bigint& modulus);
+
+//number! for a nonnegative number
+bigint factorial (const bigint& number);
+//number choose chosen for a nonnegative number, 0 when chosen is
+//negative or more than number
+bigint binomial (const bigint& number, const bigint& chosen);
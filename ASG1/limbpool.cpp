@@ -0,0 +1,133 @@
+// $Id: limbpool.cpp,v 1.1 2020-03-09 15:20:51-07 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <cstdlib>
+#include <limits>
+#include <new>
+using namespace std;
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "limbpool.h"
+#include "stats.h"
+
+//Classes run from 2^MIN_CLASS to 2^MAX_CLASS bytes.  The lists of
+//one thread together keep at most CACHE_BYTES worth of blocks, so
+//a thread never holds more than that, whichever classes it used.
+constexpr size_t MIN_CLASS = 4;
+constexpr size_t MAX_CLASS = 23;
+constexpr size_t CACHE_BYTES = size_t (1) << 24;
+
+static size_t size_class (size_t bytes) {
+   if (bytes <= size_t (1) << MIN_CLASS) return MIN_CLASS;
+   return numeric_limits<size_t>::digits - __builtin_clzl (bytes - 1);
+}
+
+//A free block holds the link to the next one.
+struct free_block {
+   free_block* next;
+};
+
+struct free_list {
+   free_block* head {nullptr};
+};
+
+//The lists go away when their thread ends, but a vector with
+//thread or static storage may be freed after that, so once they
+//are gone every block goes straight to the heap.  The flag is
+//trivially destructible, so it outlives the lists.
+static thread_local bool lists_gone = false;
+
+struct free_lists {
+   free_list lists[MAX_CLASS + 1];
+   size_t bytes {0};
+   ~free_lists() {
+      for (free_list& list: lists) {
+         while (list.head != nullptr) {
+            free_block* block = list.head;
+            list.head = block->next;
+            ::operator delete (block);
+         }
+      }
+      lists_gone = true;
+   }
+};
+
+static free_lists* lists_here() {
+   if (lists_gone) return nullptr;
+   static thread_local free_lists pool;
+   return &pool;
+}
+
+//Set once before anything long is allocated, so whether a block was
+//spilled follows from its size alone.  0 is never.
+static string spill_directory;
+static size_t spill_bytes = 0;
+
+void pool_spill (const string& directory, size_t bytes) {
+   spill_directory = directory;
+   spill_bytes = bytes;
+}
+
+static bool spilled (size_t bytes) {
+   return spill_bytes != 0 and bytes >= spill_bytes;
+}
+
+//The file is unlinked at once, so it goes when the mapping does,
+//even if the process is killed.  Its blocks are reserved up front,
+//so a full disk fails here and not as a fault on some later write.
+static void* spill_allocate (size_t bytes) {
+   string name = spill_directory + "/ydc-limbs.XXXXXX";
+   int fd = mkstemp (name.data());
+   if (fd < 0) throw bad_alloc();
+   unlink (name.c_str());
+   void* block = MAP_FAILED;
+   if (posix_fallocate (fd, 0, bytes) == 0) {
+      block = mmap (nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+   }
+   close (fd);
+   if (block == MAP_FAILED) throw bad_alloc();
+   return block;
+}
+
+void* pool_allocate (size_t bytes) {
+   if (spilled (bytes)) {
+      stats::count_allocation (bytes, false);
+      stats::count_spill (bytes);
+      return spill_allocate (bytes);
+   }
+   size_t sizeclass = size_class (bytes);
+   free_lists* pool = sizeclass > MAX_CLASS ? nullptr : lists_here();
+   free_list* list = pool != nullptr ? &pool->lists[sizeclass]
+                                     : nullptr;
+   bool reused = list != nullptr and list->head != nullptr;
+   stats::count_allocation (bytes, reused);
+   if (sizeclass > MAX_CLASS) return ::operator new (bytes);
+   if (not reused) return ::operator new (size_t (1) << sizeclass);
+   free_block* block = list->head;
+   list->head = block->next;
+   pool->bytes -= size_t (1) << sizeclass;
+   return block;
+}
+
+void pool_deallocate (void* block, size_t bytes) noexcept {
+   if (spilled (bytes)) {
+      munmap (block, bytes);
+      return;
+   }
+   size_t sizeclass = size_class (bytes);
+   free_lists* pool = sizeclass > MAX_CLASS ? nullptr : lists_here();
+   size_t class_bytes = size_t (1) << sizeclass;
+   if (pool == nullptr or pool->bytes + class_bytes > CACHE_BYTES) {
+      ::operator delete (block);
+      return;
+   }
+   free_list& list = pool->lists[sizeclass];
+   free_block* freed = static_cast<free_block*> (block);
+   freed->next = list.head;
+   list.head = freed;
+   pool->bytes += class_bytes;
+}
@@ -0,0 +1,81 @@
+// $Id: limbpool.h,v 1.1 2020-03-09 15:20:51-07 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// limbpool -
+//    Size classed pool for limb vectors and other short lived
+//    blocks.  Every arithmetic step makes a result and drops its
+//    operands, so the same few sizes are allocated and freed over
+//    and over.  Freed blocks are kept on per thread free lists, one
+//    for each power of two size, and handed out again without
+//    going to malloc, which for long vectors also saves faulting
+//    fresh pages in each time.  A request is rounded up to its
+//    class.  The lists of a thread keep at most 16 MiB of blocks
+//    between them, freed when the thread ends, and blocks larger
+//    than the largest class go straight to the heap.
+//
+//    The lists are per thread, so they take no locks.  A block may
+//    be freed by another thread than the one that allocated it, and
+//    joins the list of the thread that frees it.
+//
+//    Blocks too long to keep in memory may instead be spilled to
+//    files, each one an unlinked file in a scratch directory mapped
+//    into memory.  The kernel then pages them out to the file
+//    rather than to swap, and a full disk is a bad_alloc rather
+//    than a killed process.  The arithmetic runs on them unchanged.
+//    Addition, subtraction, comparison and conversion go through
+//    the limbs in order, so they mostly read ahead, but the passes
+//    of a number theoretic transform stride across the whole
+//    buffer, so a multiply whose transforms outgrow memory pages at
+//    random and is very slow.  Only a block as long as the spill
+//    size is spilled; the shorter blocks kept on the lists stay in
+//    memory, up to 16 MiB per thread, and are not counted against
+//    it.
+//
+
+#ifndef __LIMBPOOL_H__
+#define __LIMBPOOL_H__
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+using namespace std;
+
+// pool_allocate, pool_deallocate -
+//    A block of at least bytes bytes, and its release.  bytes must
+//    be the same in both calls.
+void* pool_allocate (size_t bytes);
+void pool_deallocate (void* block, size_t bytes) noexcept;
+
+// pool_spill -
+//    From now on, make every block of at least bytes bytes a mapped
+//    file in directory.  Must be called before any block that long
+//    is allocated, and before any other thread starts.
+void pool_spill (const string& directory, size_t bytes);
+
+// pool_allocator -
+//    Standard allocator over the pool, for vector and allocate_shared.
+//    All instances are interchangeable.
+template <typename value_t>
+struct pool_allocator {
+   using value_type = value_t;
+   using is_always_equal = true_type;
+   pool_allocator() = default;
+   template <typename other_t>
+   pool_allocator (const pool_allocator<other_t>&) noexcept {}
+   value_t* allocate (size_t count) {
+      return static_cast<value_t*> (
+             pool_allocate (count * sizeof (value_t)));
+   }
+   void deallocate (value_t* block, size_t count) noexcept {
+      pool_deallocate (block, count * sizeof (value_t));
+   }
+};
+
+template <typename left_t, typename right_t>
+bool operator== (const pool_allocator<left_t>&,
+                 const pool_allocator<right_t>&) {
+   return true;
+}
+
+#endif
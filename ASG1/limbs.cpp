@@ -0,0 +1,398 @@
+// $Id: limbs.cpp,v 1.1 2020-01-20 14:02:11-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#if defined (__x86_64__) or defined (__i386__)
+#include <immintrin.h>
+#endif
+using namespace std;
+
+#include "limbs.h"
+
+//
+// The scalar kernels.  These are the reference versions and handle
+// the tails that are too short for a vector.
+//
+
+static limb_t add_n_scalar (limb_t* r, const limb_t* a,
+                            const limb_t* b, size_t n) {
+   dlimb_t carry = 0;
+   for (size_t iter = 0; iter < n; ++iter) {
+      carry += static_cast<dlimb_t>(a[iter]) + b[iter];
+      r[iter] = static_cast<limb_t>(carry);
+      carry >>= LIMB_BITS;
+   }
+   return static_cast<limb_t>(carry);
+}
+
+static limb_t sub_n_scalar (limb_t* r, const limb_t* a,
+                            const limb_t* b, size_t n) {
+   limb_t borrow = 0;
+   for (size_t iter = 0; iter < n; ++iter) {
+      dlimb_t temp = static_cast<dlimb_t>(a[iter]) - b[iter] - borrow;
+      r[iter] = static_cast<limb_t>(temp);
+      borrow = (temp >> LIMB_BITS) != 0;
+   }
+   return borrow;
+}
+
+static int cmp_n_scalar (const limb_t* a, const limb_t* b, size_t n) {
+   while (n-- > 0) {
+      if (a[n] != b[n]) return a[n] < b[n] ? -1 : 1;
+   }
+   return 0;
+}
+
+limb_t add_1 (limb_t* a, size_t n, limb_t b) {
+   for (size_t iter = 0; b != 0 and iter < n; ++iter) {
+      a[iter] += b;
+      b = a[iter] < b;
+   }
+   return b;
+}
+
+limb_t sub_1 (limb_t* a, size_t n, limb_t b) {
+   for (size_t iter = 0; b != 0 and iter < n; ++iter) {
+      limb_t before = a[iter];
+      a[iter] -= b;
+      b = before < b;
+   }
+   return b;
+}
+
+#if defined (__x86_64__) or defined (__i386__)
+//
+// The vector kernels work on a block of W limbs at once.  Adding the
+// blocks lane by lane leaves each lane either generating a carry
+// (the sum wrapped), propagating one (the sum is all ones) or
+// neither, and never both.  With those as W bit masks G and P and
+// the carry in c, the carry into each lane is the carry-lookahead
+//    ((G << 1 | c) + P) ^ P
+// and bit W of the sum inside is the carry out of the block.  The
+// carries are then added back in one vector step.  Subtraction is
+// the same with borrows, where a difference of zero propagates.
+// The lanes are compared as signed after flipping the top bit,
+// since SSE and AVX2 have no unsigned 32 bit compare.
+//
+
+//carry mask into each of the width lanes; updates carry to the
+//carry out of the block
+static inline unsigned lookahead (unsigned generate, unsigned propagate,
+                                  unsigned& carry, int width) {
+   unsigned sum = ((generate << 1) | carry) + propagate;
+   carry = (sum >> width) & 1;
+   return (sum ^ propagate) & ((1u << width) - 1);
+}
+
+//all ones in the lanes whose bit is set in mask
+__attribute__ ((target ("avx2")))
+static inline __m256i lane_mask_avx2 (unsigned mask) {
+   const __m256i bits = _mm256_setr_epi32 (1, 2, 4, 8,
+                                           16, 32, 64, 128);
+   __m256i spread = _mm256_set1_epi32 (static_cast<int>(mask));
+   return _mm256_cmpeq_epi32 (_mm256_and_si256 (spread, bits), bits);
+}
+
+__attribute__ ((target ("avx2")))
+static inline unsigned lane_bits_avx2 (__m256i lanes) {
+   return _mm256_movemask_ps (_mm256_castsi256_ps (lanes));
+}
+
+__attribute__ ((target ("avx2")))
+static limb_t add_n_avx2 (limb_t* r, const limb_t* a,
+                          const limb_t* b, size_t n) {
+   const __m256i bias = _mm256_set1_epi32 (INT32_MIN);
+   const __m256i ones = _mm256_set1_epi32 (-1);
+   unsigned carry = 0;
+   size_t iter = 0;
+   for (; iter + 8 <= n; iter += 8) {
+      __m256i left = _mm256_loadu_si256 (
+                     reinterpret_cast<const __m256i*>(a + iter));
+      __m256i right = _mm256_loadu_si256 (
+                      reinterpret_cast<const __m256i*>(b + iter));
+      __m256i sum = _mm256_add_epi32 (left, right);
+      //the sum wrapped if it came out below the left operand
+      unsigned generate = lane_bits_avx2 (_mm256_cmpgt_epi32 (
+                          _mm256_xor_si256 (left, bias),
+                          _mm256_xor_si256 (sum, bias)));
+      unsigned propagate = lane_bits_avx2 (
+                           _mm256_cmpeq_epi32 (sum, ones));
+      unsigned carries = lookahead (generate, propagate, carry, 8);
+      sum = _mm256_sub_epi32 (sum, lane_mask_avx2 (carries));
+      _mm256_storeu_si256 (reinterpret_cast<__m256i*>(r + iter), sum);
+   }
+   limb_t tail = add_n_scalar (r + iter, a + iter, b + iter, n - iter);
+   return tail + add_1 (r + iter, n - iter, carry);
+}
+
+__attribute__ ((target ("avx2")))
+static limb_t sub_n_avx2 (limb_t* r, const limb_t* a,
+                          const limb_t* b, size_t n) {
+   const __m256i bias = _mm256_set1_epi32 (INT32_MIN);
+   const __m256i zero = _mm256_setzero_si256();
+   unsigned borrow = 0;
+   size_t iter = 0;
+   for (; iter + 8 <= n; iter += 8) {
+      __m256i left = _mm256_loadu_si256 (
+                     reinterpret_cast<const __m256i*>(a + iter));
+      __m256i right = _mm256_loadu_si256 (
+                      reinterpret_cast<const __m256i*>(b + iter));
+      __m256i diff = _mm256_sub_epi32 (left, right);
+      unsigned generate = lane_bits_avx2 (_mm256_cmpgt_epi32 (
+                          _mm256_xor_si256 (right, bias),
+                          _mm256_xor_si256 (left, bias)));
+      unsigned propagate = lane_bits_avx2 (
+                           _mm256_cmpeq_epi32 (diff, zero));
+      unsigned borrows = lookahead (generate, propagate, borrow, 8);
+      diff = _mm256_add_epi32 (diff, lane_mask_avx2 (borrows));
+      _mm256_storeu_si256 (reinterpret_cast<__m256i*>(r + iter), diff);
+   }
+   limb_t tail = sub_n_scalar (r + iter, a + iter, b + iter, n - iter);
+   return tail + sub_1 (r + iter, n - iter, borrow);
+}
+
+__attribute__ ((target ("avx2")))
+static int cmp_n_avx2 (const limb_t* a, const limb_t* b, size_t n) {
+   while (n >= 8) {
+      n -= 8;
+      __m256i left = _mm256_loadu_si256 (
+                     reinterpret_cast<const __m256i*>(a + n));
+      __m256i right = _mm256_loadu_si256 (
+                      reinterpret_cast<const __m256i*>(b + n));
+      //four mask bits per lane; find the highest lane that differs
+      unsigned differ = ~_mm256_movemask_epi8 (
+                        _mm256_cmpeq_epi32 (left, right));
+      if (differ != 0) {
+         size_t lane = n + (31 - __builtin_clz (differ)) / 4;
+         return a[lane] < b[lane] ? -1 : 1;
+      }
+   }
+   return cmp_n_scalar (a, b, n);
+}
+
+__attribute__ ((target ("sse4.2")))
+static inline __m128i lane_mask_sse42 (unsigned mask) {
+   const __m128i bits = _mm_setr_epi32 (1, 2, 4, 8);
+   __m128i spread = _mm_set1_epi32 (static_cast<int>(mask));
+   return _mm_cmpeq_epi32 (_mm_and_si128 (spread, bits), bits);
+}
+
+__attribute__ ((target ("sse4.2")))
+static inline unsigned lane_bits_sse42 (__m128i lanes) {
+   return _mm_movemask_ps (_mm_castsi128_ps (lanes));
+}
+
+__attribute__ ((target ("sse4.2")))
+static limb_t add_n_sse42 (limb_t* r, const limb_t* a,
+                           const limb_t* b, size_t n) {
+   const __m128i bias = _mm_set1_epi32 (INT32_MIN);
+   const __m128i ones = _mm_set1_epi32 (-1);
+   unsigned carry = 0;
+   size_t iter = 0;
+   for (; iter + 4 <= n; iter += 4) {
+      __m128i left = _mm_loadu_si128 (
+                     reinterpret_cast<const __m128i*>(a + iter));
+      __m128i right = _mm_loadu_si128 (
+                      reinterpret_cast<const __m128i*>(b + iter));
+      __m128i sum = _mm_add_epi32 (left, right);
+      unsigned generate = lane_bits_sse42 (_mm_cmpgt_epi32 (
+                          _mm_xor_si128 (left, bias),
+                          _mm_xor_si128 (sum, bias)));
+      unsigned propagate = lane_bits_sse42 (
+                           _mm_cmpeq_epi32 (sum, ones));
+      unsigned carries = lookahead (generate, propagate, carry, 4);
+      sum = _mm_sub_epi32 (sum, lane_mask_sse42 (carries));
+      _mm_storeu_si128 (reinterpret_cast<__m128i*>(r + iter), sum);
+   }
+   limb_t tail = add_n_scalar (r + iter, a + iter, b + iter, n - iter);
+   return tail + add_1 (r + iter, n - iter, carry);
+}
+
+__attribute__ ((target ("sse4.2")))
+static limb_t sub_n_sse42 (limb_t* r, const limb_t* a,
+                           const limb_t* b, size_t n) {
+   const __m128i bias = _mm_set1_epi32 (INT32_MIN);
+   const __m128i zero = _mm_setzero_si128();
+   unsigned borrow = 0;
+   size_t iter = 0;
+   for (; iter + 4 <= n; iter += 4) {
+      __m128i left = _mm_loadu_si128 (
+                     reinterpret_cast<const __m128i*>(a + iter));
+      __m128i right = _mm_loadu_si128 (
+                      reinterpret_cast<const __m128i*>(b + iter));
+      __m128i diff = _mm_sub_epi32 (left, right);
+      unsigned generate = lane_bits_sse42 (_mm_cmpgt_epi32 (
+                          _mm_xor_si128 (right, bias),
+                          _mm_xor_si128 (left, bias)));
+      unsigned propagate = lane_bits_sse42 (
+                           _mm_cmpeq_epi32 (diff, zero));
+      unsigned borrows = lookahead (generate, propagate, borrow, 4);
+      diff = _mm_add_epi32 (diff, lane_mask_sse42 (borrows));
+      _mm_storeu_si128 (reinterpret_cast<__m128i*>(r + iter), diff);
+   }
+   limb_t tail = sub_n_scalar (r + iter, a + iter, b + iter, n - iter);
+   return tail + sub_1 (r + iter, n - iter, borrow);
+}
+
+__attribute__ ((target ("sse4.2")))
+static int cmp_n_sse42 (const limb_t* a, const limb_t* b, size_t n) {
+   while (n >= 4) {
+      n -= 4;
+      __m128i left = _mm_loadu_si128 (
+                     reinterpret_cast<const __m128i*>(a + n));
+      __m128i right = _mm_loadu_si128 (
+                      reinterpret_cast<const __m128i*>(b + n));
+      unsigned differ = ~_mm_movemask_epi8 (
+                        _mm_cmpeq_epi32 (left, right)) & 0xFFFF;
+      if (differ != 0) {
+         size_t lane = n + (31 - __builtin_clz (differ)) / 4;
+         return a[lane] < b[lane] ? -1 : 1;
+      }
+   }
+   return cmp_n_scalar (a, b, n);
+}
+
+#endif
+
+const vector<limb_kernels>& limb_kernel_sets() {
+   static const vector<limb_kernels> sets = []() {
+      vector<limb_kernels> found {
+         {"scalar", add_n_scalar, sub_n_scalar, cmp_n_scalar},
+      };
+#if defined (__x86_64__) or defined (__i386__)
+      if (__builtin_cpu_supports ("sse4.2")) {
+         found.push_back ({"sse4.2", add_n_sse42, sub_n_sse42,
+                           cmp_n_sse42});
+      }
+      if (__builtin_cpu_supports ("avx2")) {
+         found.push_back ({"avx2", add_n_avx2, sub_n_avx2,
+                           cmp_n_avx2});
+      }
+#endif
+      return found;
+   }();
+   return sets;
+}
+
+//the last set found is the widest this CPU runs
+static const limb_kernels& kernels() {
+   static const limb_kernels& best = limb_kernel_sets().back();
+   return best;
+}
+
+limb_t add_n (limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+   return kernels().add_n (r, a, b, n);
+}
+
+limb_t sub_n (limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+   return kernels().sub_n (r, a, b, n);
+}
+
+int cmp_n (const limb_t* a, const limb_t* b, size_t n) {
+   return kernels().cmp_n (a, b, n);
+}
+
+limb_t add (limb_t* r, const limb_t* a, size_t an,
+            const limb_t* b, size_t bn) {
+   limb_t carry = add_n (r, a, b, bn);
+   if (r != a) {
+      for (size_t iter = bn; iter < an; ++iter) r[iter] = a[iter];
+   }
+   return add_1 (r + bn, an - bn, carry);
+}
+
+limb_t sub (limb_t* r, const limb_t* a, size_t an,
+            const limb_t* b, size_t bn) {
+   limb_t borrow = sub_n (r, a, b, bn);
+   if (r != a) {
+      for (size_t iter = bn; iter < an; ++iter) r[iter] = a[iter];
+   }
+   return sub_1 (r + bn, an - bn, borrow);
+}
+
+limb_t mul_1 (limb_t* r, const limb_t* a, size_t n, limb_t b) {
+   dlimb_t carry = 0;
+   for (size_t iter = 0; iter < n; ++iter) {
+      carry += static_cast<dlimb_t>(a[iter]) * b;
+      r[iter] = static_cast<limb_t>(carry);
+      carry >>= LIMB_BITS;
+   }
+   return static_cast<limb_t>(carry);
+}
+
+limb_t addmul_1 (limb_t* r, const limb_t* a, size_t n, limb_t b) {
+   dlimb_t carry = 0;
+   for (size_t iter = 0; iter < n; ++iter) {
+      //(2^32-1)^2 + 2 * (2^32-1) == 2^64-1, so the
+      //interim product can never overflow 64 bits
+      carry += static_cast<dlimb_t>(a[iter]) * b + r[iter];
+      r[iter] = static_cast<limb_t>(carry);
+      carry >>= LIMB_BITS;
+   }
+   return static_cast<limb_t>(carry);
+}
+
+limb_t submul_1 (limb_t* r, const limb_t* a, size_t n, limb_t b) {
+   dlimb_t borrow = 0;
+   for (size_t iter = 0; iter < n; ++iter) {
+      borrow += static_cast<dlimb_t>(a[iter]) * b;
+      limb_t low = static_cast<limb_t>(borrow);
+      borrow >>= LIMB_BITS;
+      borrow += r[iter] < low;
+      r[iter] -= low;
+   }
+   return static_cast<limb_t>(borrow);
+}
+
+limb_t lshift (limb_t* r, const limb_t* a, size_t n, int shift) {
+   if (shift == 0) {
+      if (r != a) copy (a, a + n, r);
+      return 0;
+   }
+   limb_t out = 0;
+   for (size_t iter = 0; iter < n; ++iter) {
+      limb_t limb = a[iter];
+      r[iter] = (limb << shift) | out;
+      out = limb >> (LIMB_BITS - shift);
+   }
+   return out;
+}
+
+limb_t rshift (limb_t* r, const limb_t* a, size_t n, int shift) {
+   if (shift == 0) {
+      if (r != a) copy (a, a + n, r);
+      return 0;
+   }
+   limb_t out = 0;
+   for (size_t iter = n; iter-- > 0;) {
+      limb_t limb = a[iter];
+      r[iter] = (limb >> shift) | out;
+      out = limb << (LIMB_BITS - shift);
+   }
+   return out;
+}
+
+limb_t divrem_1 (limb_t* q, const limb_t* a, size_t n, limb_t d) {
+   dlimb_t remainder = 0;
+   for (size_t iter = n; iter-- > 0;) {
+      dlimb_t interim = (remainder << LIMB_BITS) | a[iter];
+      q[iter] = static_cast<limb_t>(interim / d);
+      remainder = interim % d;
+   }
+   return static_cast<limb_t>(remainder);
+}
+
+void mul_basecase (limb_t* r, const limb_t* a, size_t an,
+                   const limb_t* b, size_t bn) {
+   r[an] = mul_1 (r, a, an, b[0]);
+   for (size_t iter = 1; iter < bn; ++iter) {
+      r[an + iter] = addmul_1 (r + iter, a, an, b[iter]);
+   }
+}
+
+size_t normalized_size (const limb_t* a, size_t n) {
+   while (n > 0 and a[n - 1] == 0) --n;
+   return n;
+}
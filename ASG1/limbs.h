@@ -0,0 +1,96 @@
+// $Id: limbs.h,v 1.1 2020-01-20 14:02:11-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// limbs -
+//    Kernels that operate on raw arrays of base 2^32 limbs stored
+//    least significant first.  These are shared by ubigint and by
+//    the multiply engine, and know nothing about normalization
+//    except where noted.
+//
+
+#ifndef __LIMBS_H__
+#define __LIMBS_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+#include "limbpool.h"
+
+using limb_t = uint32_t;
+using dlimb_t = uint64_t;
+using limbvec = vector<limb_t, pool_allocator<limb_t>>;
+constexpr int LIMB_BITS = 32;
+
+// add_n, sub_n -
+//    r[0..n) = a[0..n) +/- b[0..n).  Returns the carry or borrow out.
+//    r may alias a or b.
+limb_t add_n (limb_t* r, const limb_t* a, const limb_t* b, size_t n);
+limb_t sub_n (limb_t* r, const limb_t* a, const limb_t* b, size_t n);
+
+// add, sub -
+//    r[0..an) = a[0..an) +/- b[0..bn), where an >= bn.  Returns the
+//    carry or borrow out.  r may alias a.
+limb_t add (limb_t* r, const limb_t* a, size_t an,
+            const limb_t* b, size_t bn);
+limb_t sub (limb_t* r, const limb_t* a, size_t an,
+            const limb_t* b, size_t bn);
+
+// add_1, sub_1 -
+//    Ripple a single limb into a[0..n) in place.  Returns the carry
+//    or borrow out.
+limb_t add_1 (limb_t* a, size_t n, limb_t b);
+limb_t sub_1 (limb_t* a, size_t n, limb_t b);
+
+// cmp_n -
+//    Compare a[0..n) with b[0..n), returning -1, 0 or 1.
+int cmp_n (const limb_t* a, const limb_t* b, size_t n);
+
+// limb_kernels -
+//    add_n, sub_n and cmp_n come in scalar, SSE4.2 and AVX2
+//    versions.  limb_kernel_sets lists the ones this CPU can run,
+//    scalar first and widest last, and the plain functions above
+//    call the last one.  The list is there for benchmarks.
+struct limb_kernels {
+   const char* name;
+   limb_t (*add_n) (limb_t*, const limb_t*, const limb_t*, size_t);
+   limb_t (*sub_n) (limb_t*, const limb_t*, const limb_t*, size_t);
+   int (*cmp_n) (const limb_t*, const limb_t*, size_t);
+};
+const vector<limb_kernels>& limb_kernel_sets();
+
+// mul_1, addmul_1 -
+//    r[0..n) = a[0..n) * b, or r[0..n) += a[0..n) * b.  Returns the
+//    high limb that did not fit.
+limb_t mul_1 (limb_t* r, const limb_t* a, size_t n, limb_t b);
+limb_t addmul_1 (limb_t* r, const limb_t* a, size_t n, limb_t b);
+
+// submul_1 -
+//    r[0..n) -= a[0..n) * b.  Returns the high limb still to be
+//    subtracted from r[n].
+limb_t submul_1 (limb_t* r, const limb_t* a, size_t n, limb_t b);
+
+// lshift, rshift -
+//    r[0..n) = a[0..n) shifted left or right by 0 <= shift < 32
+//    bits.  Returns the bits shifted out, in the low bits for lshift
+//    and in the high bits for rshift.  r may alias a.
+limb_t lshift (limb_t* r, const limb_t* a, size_t n, int shift);
+limb_t rshift (limb_t* r, const limb_t* a, size_t n, int shift);
+
+// divrem_1 -
+//    q[0..n) = a[0..n) / d.  Returns the remainder.  q may alias a.
+limb_t divrem_1 (limb_t* q, const limb_t* a, size_t n, limb_t d);
+
+// mul_basecase -
+//    Schoolbook product r[0..an+bn) = a[0..an) * b[0..bn).  r must
+//    not alias a or b.
+void mul_basecase (limb_t* r, const limb_t* a, size_t an,
+                   const limb_t* b, size_t bn);
+
+// normalized_size -
+//    Length of a[0..n) with the high zero limbs dropped.
+size_t normalized_size (const limb_t* a, size_t n);
+
+#endif
@@ -1,162 +1,698 @@
 // $Id: main.cpp,v 1.2 2019-12-12 19:22:40-08 - - $
 // Sasank Madineni (smadinen)
 // Perry Ralston (pdralsto)
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <deque>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 using namespace std;
 
+#include <fcntl.h>
 #include <unistd.h>
 
 #include "bigint.h"
 #include "debug.h"
-#include "iterstack.h"
 #include "libfns.h"
+#include "limbpool.h"
+#include "printer.h"
+#include "program.h"
 #include "scanner.h"
+#include "snapshot.h"
+#include "stats.h"
 #include "util.h"
+#include "value.h"
+#include "workpool.h"
 
-using bigint_stack = iterstack<bigint>;
+//throw unless there are count values on the stack and the top
+//count of them are all numbers
+void need_numbers (value_stack& stack, size_t count) {
+   if (stack.size() < count) throw ydc_error ("stack empty");
+   auto entry = stack.begin();
+   for (size_t index = 0; index < count; ++index, ++entry) {
+      if (not entry->is_number()) throw ydc_error ("non-numeric value");
+   }
+}
+
+//The state a script sees besides its stack, the k register, the
+//registers, and the macro depth, is per thread, so that batch jobs
+//running at the same time each have their own.
+
+//the k register: digits kept after the point by / % ^ and *
+constexpr size_t UNKNOWN_PRECISION = numeric_limits<size_t>::max();
+thread_local size_t precision = 0;
+
+//true if the result of oper depends on precision, which is not
+//known while a script is being compiled
+bool uses_precision (char oper, const bigdecimal& left,
+                     const bigdecimal& right) {
+   switch (oper) {
+      case '+': case '-': return false;
+      case '*': return left.scale() > 0 and right.scale() > 0;
+      case '^': return left.scale() > 0 or right.integer() < bigint (0);
+      default : return true;
+   }
+}
 
-void do_arith (bigint_stack& stack, const char oper) {
-   if (stack.size() < 2) throw ydc_error ("stack empty");
-   bigint right = stack.top();
+void do_arith (value_stack& stack, const char oper) {
+   need_numbers (stack, 2);
+   if (precision == UNKNOWN_PRECISION) {
+      auto entry = stack.begin();
+      const bigdecimal& top = entry->number();
+      if (uses_precision (oper, (++entry)->number(), top)) {
+         throw ydc_error ("precision not known");
+      }
+   }
+   //a product of long integers may be left pending, see value.h
+   if (oper == '*') {
+      value right = move (stack.top());
+      stack.pop();
+      if (stack.top().multiply_later (move (right))) return;
+      stack.push (move (right));
+   }
+   bigdecimal right = move (stack.top().number());
    stack.pop();
    DEBUGF ('d', "right = " << right);
-   bigint left = stack.top();
-   stack.pop();
+   //the result replaces left in place on the stack
+   bigdecimal& left = stack.top().number();
    DEBUGF ('d', "left = " << left);
-   bigint result;
-   switch (oper) {
-      case '+': result = left + right; break;
-      case '-': result = left - right; break;
-      case '*': result = left * right; break;
-      case '/': result = left / right; break;
-      case '%': result = left % right; break;
-      case '^': result = pow (left, right); break;
-      default: throw invalid_argument ("do_arith operator "s + oper);
+   try {
+      switch (oper) {
+         case '+': left += right; break;
+         case '-': left -= right; break;
+         case '*': left.multiply_by (right, precision); break;
+         case '/': left.divide_by (right, precision); break;
+         case '%': left.remainder_by (right, precision); break;
+         case '^': left.raise_to (right, precision); break;
+         default: throw invalid_argument ("do_arith operator "s + oper);
+      }
+   }catch (domain_error& error) {
+      //division by zero is the user's mistake, not ours
+      stack.pop();
+      throw ydc_error (error.what());
+   }
+   DEBUGF ('d', "result = " << left);
+}
+
+//base exponent modulus | leaves base^exponent % modulus, all taken
+//as integers
+void do_powmod (value_stack& stack, const char) {
+   need_numbers (stack, 3);
+   bigint modulus = stack.top().number().integer();
+   stack.pop();
+   bigint exponent = stack.top().number().integer();
+   stack.pop();
+   bigint base = stack.top().number().integer();
+   DEBUGF ('d', "base = " << base << ", exponent = " << exponent
+                << ", modulus = " << modulus);
+   try {
+      stack.top() = value (powmod (base, exponent, modulus));
+   }catch (domain_error& error) {
+      stack.pop();
+      throw ydc_error (error.what());
+   }
+   DEBUGF ('d', "result = " << stack.top().number());
+}
+
+//v replaces the top with its square root, to the larger of k and
+//its own scale
+void do_sqrt (value_stack& stack, const char) {
+   need_numbers (stack, 1);
+   if (precision == UNKNOWN_PRECISION) {
+      throw ydc_error ("precision not known");
+   }
+   bigdecimal& top = stack.top().number();
+   DEBUGF ('d', "top = " << top);
+   try {
+      top.square_root (precision);
+   }catch (domain_error& error) {
+      stack.pop();
+      throw ydc_error (error.what());
+   }
+   DEBUGF ('d', "result = " << top);
+}
+
+//a b G leaves the gcd of a and b, and a m M leaves the inverse of a
+//modulo m, both taking their operands as integers
+void do_number_theory (value_stack& stack, const char oper) {
+   need_numbers (stack, 2);
+   bigint right = stack.top().number().integer();
+   stack.pop();
+   bigint left = stack.top().number().integer();
+   DEBUGF ('d', "left = " << left << ", right = " << right);
+   try {
+      switch (oper) {
+         case 'G': stack.top() = value (gcd (left, right)); break;
+         case 'M': stack.top() = value (modinv (left, right)); break;
+         default: throw invalid_argument ("do_number_theory operator "s
+                                          + oper);
+      }
+   }catch (domain_error& error) {
+      stack.pop();
+      throw ydc_error (error.what());
+   }
+   DEBUGF ('d', "result = " << stack.top().number());
+}
+
+//n ! leaves n factorial, and n k C leaves n choose k, both taking
+//their operands as integers
+void do_combinatorics (value_stack& stack, const char oper) {
+   need_numbers (stack, oper == '!' ? 1 : 2);
+   bigint right;
+   if (oper == 'C') {
+      right = stack.top().number().integer();
+      stack.pop();
+   }
+   bigint left = stack.top().number().integer();
+   DEBUGF ('d', "left = " << left << ", right = " << right);
+   try {
+      switch (oper) {
+         case '!': stack.top() = value (factorial (left)); break;
+         case 'C': stack.top() = value (binomial (left, right)); break;
+         default: throw invalid_argument ("do_combinatorics operator "s
+                                          + oper);
+      }
+   }catch (domain_error& error) {
+      stack.pop();
+      throw ydc_error (error.what());
    }
-   DEBUGF ('d', "result = " << result);
-   stack.push (result);
+   DEBUGF ('d', "result = " << stack.top().number());
 }
 
-void do_clear (bigint_stack& stack, const char) {
+//k pops a nonnegative integer into the k register
+void do_precision (value_stack& stack, const char) {
+   need_numbers (stack, 1);
+   const bigdecimal& top = stack.top().number();
+   unsigned long digits = 0;
+   if (top.scale() != 0 or not top.integer().to_ulong (digits)
+       or digits > numeric_limits<long>::max()) {
+      throw ydc_error ("scale must be a nonnegative integer");
+   }
+   precision = digits;
+   stack.pop();
+}
+
+//K pushes the k register
+void do_push_precision (value_stack& stack, const char) {
+   stack.push (value (bigint (static_cast<long> (precision))));
+}
+
+void do_clear (value_stack& stack, const char) {
    DEBUGF ('d', "");
    stack.clear();
 }
 
-
-void do_dup (bigint_stack& stack, const char) {
-   bigint top = stack.top();
-   DEBUGF ('d', top);
+
+//the copy shares the top's limbs or text, so this is cheap
+void do_dup (value_stack& stack, const char) {
+   if (stack.size() < 1) throw ydc_error ("stack empty");
+   value top = stack.top();
    stack.push (top);
 }
 
-void do_printall (bigint_stack& stack, const char) {
-   for (const auto& elem: stack) cout << elem << endl;
+void print_value (const value& entry) {
+   if (entry.is_number()) {
+      printer::print (entry.number());
+   }else {
+      printer::print (entry.text());
+   }
 }
 
-void do_print (bigint_stack& stack, const char) {
+void do_printall (value_stack& stack, const char) {
+   for (const auto& elem: stack) print_value (elem);
+}
+
+void do_print (value_stack& stack, const char) {
    if (stack.size() < 1) throw ydc_error ("stack empty");
-   cout << stack.top() << endl;
+   print_value (stack.top());
 }
 
-void do_debug (bigint_stack&, const char) {
-   cout << "Y not implemented" << endl;
+//Y prints what every operator has cost so far, in all threads
+void do_debug (value_stack& stack, const char) {
+   string report;
+   size_t bits = stack.size() > 0 ? stack.top().bit_length() : 0;
+   stats::report (report, 'Y', bits, stack.size());
+   printer::append (report);
+}
+
+//[file] W saves the stack below the name to file, and [file] R
+//pushes what a snapshot in file holds, see snapshot.h
+void do_snapshot (value_stack& stack, const char oper) {
+   if (stack.size() < 1) throw ydc_error ("stack empty");
+   if (stack.top().is_number()) {
+      throw ydc_error ("file name must be a string");
+   }
+   string filename = stack.top().text();
+   stack.pop();
+   if (oper == 'W') {
+      save_snapshot (filename, stack);
+   }else {
+      load_snapshot (filename, stack);
+   }
 }
 
 class ydc_quit: public exception {};
-void do_quit (bigint_stack&, const char) {
+void do_quit (value_stack&, const char) {
    throw ydc_quit();
 }
 
-string unimplemented (char oper) {
-   if (isgraph (oper)) {
-      return "'"s + oper + "' ("s + octal (oper) + ") unimplemented";
+//a character as error messages show it, e.g. 'a' (0141)
+string describe (char symbol) {
+   if (isgraph (symbol)) {
+      return "'"s + symbol + "' ("s + octal (symbol) + ")";
    }else {
-      return octal (oper) + " unimplemented"s;
+      return octal (symbol);
    }
 }
 
-void do_function (bigint_stack& stack, const char oper) {
+void do_unimplemented (value_stack&, const char oper) {
+   throw ydc_error (describe (oper) + " unimplemented");
+}
+
+//registers are indexed by the character that names them
+thread_local array<optional<value>, UCHAR_MAX + 1> registers;
+
+optional<value>& register_named (char name) {
+   return registers[static_cast<unsigned char> (name)];
+}
+
+//sr pops the top of the stack into register r
+void do_store (value_stack& stack, const char name) {
+   if (stack.size() < 1) throw ydc_error ("stack empty");
+   register_named (name) = move (stack.top());
+   stack.pop();
+}
+
+//lr pushes a copy of register r, leaving r as it was
+void do_load (value_stack& stack, const char name) {
+   const optional<value>& saved = register_named (name);
+   if (not saved) {
+      throw ydc_error ("register " + describe (name) + " is empty");
+   }
+   stack.push (*saved);
+}
+
+void interpret (scanner& input, value_stack& stack);
+
+//x pops a string and runs it as a macro on the same stack, or
+//leaves a number where it is
+void do_execute (value_stack& stack, const char) {
+   static constexpr size_t MAX_DEPTH = 1 << 12;
+   static thread_local size_t depth = 0;
+   if (stack.size() < 1) throw ydc_error ("stack empty");
+   if (stack.top().is_number()) return;
+   if (depth == MAX_DEPTH) throw ydc_error ("macro nesting too deep");
+   //the copy keeps the text alive even if the macro stores over it
+   value macro = move (stack.top());
+   stack.pop();
+   scanner input (macro.text());
+   ++depth;
+   try {
+      interpret (input, stack);
+   }catch (...) {
+      --depth;
+      throw;
+   }
+   --depth;
+}
+
+//the second field is how many operands a pure operation takes,
+//so that a compiled script may fold it over constants
+operation lookup (char oper) {
    switch (oper) {
-      case '+': do_arith    (stack, oper); break;
-      case '-': do_arith    (stack, oper); break;
-      case '*': do_arith    (stack, oper); break;
-      case '/': do_arith    (stack, oper); break;
-      case '%': do_arith    (stack, oper); break;
-      case '^': do_arith    (stack, oper); break;
-      case 'Y': do_debug    (stack, oper); break;
-      case 'c': do_clear    (stack, oper); break;
-      case 'd': do_dup      (stack, oper); break;
-      case 'f': do_printall (stack, oper); break;
-      case 'p': do_print    (stack, oper); break;
-      case 'q': do_quit     (stack, oper); break;
-      default : throw ydc_error (unimplemented (oper));
-   }
-}
-
-
+      case '!': return {do_combinatorics, 1};
+      case '+': return {do_arith     , 2};
+      case '-': return {do_arith     , 2};
+      case '*': return {do_arith     , 2};
+      case '/': return {do_arith     , 2};
+      case '%': return {do_arith     , 2};
+      case '^': return {do_arith     , 2};
+      case '|': return {do_powmod    , 3};
+      case 'C': return {do_combinatorics, 2};
+      case 'G': return {do_number_theory, 2};
+      case 'K': return {do_push_precision, 0};
+      case 'M': return {do_number_theory, 2};
+      case 'R': return {do_snapshot  , 0};
+      case 'W': return {do_snapshot  , 0};
+      case 'Y': return {do_debug     , 0};
+      case 'c': return {do_clear     , 0};
+      case 'd': return {do_dup       , 1};
+      case 'f': return {do_printall  , 0};
+      case 'k': return {do_precision , 0};
+      case 'l': return {do_load      , 0};
+      case 'p': return {do_print     , 0};
+      case 'q': return {do_quit      , 0};
+      case 's': return {do_store     , 0};
+      case 'v': return {do_sqrt      , 1};
+      case 'x': return {do_execute   , 0};
+      default : return {do_unimplemented, 0};
+   }
+}
+
+void report (const ydc_error& error) {
+   printer::print (exec::execname() + ": " + error.what());
+}
+
+//interpret input a token at a time until end of file
+void interpret (scanner& input, value_stack& stack) {
+   for (;;) {
+      try {
+         token lexeme = input.scan();
+         switch (lexeme.symbol) {
+            case tsymbol::SCANEOF:
+               return;
+            case tsymbol::NUMBER:
+               stack.push (bigdecimal (lexeme.lexinfo));
+               stats::count_depth (stack.size());
+               break;
+            case tsymbol::STRING:
+               stack.push (value (lexeme.lexinfo));
+               stats::count_depth (stack.size());
+               break;
+            case tsymbol::OPERATOR:
+               //an operator naming a register is passed the register
+               perform (lookup (lexeme.lexinfo[0]).function, stack,
+                        lexeme.lexinfo[0], lexeme.lexinfo.back());
+               break;
+            default:
+               assert (false);
+         }
+      }catch (ydc_error& error) {
+         report (error);
+      }
+   }
+}
+
+//an error in reading an input, which a batch job keeps with its
+//output so that it comes out in order
+void input_error (const string& name, const string& message) {
+   exec::status (EXIT_FAILURE);
+   printer::error (exec::execname() + ": " + name + ": " + message
+                   + "\n");
+}
+
+//an input that is a snapshot is loaded onto the stack, and any
+//other input is interpreted
+void read_input (const string& name, int fd, value_stack& stack) {
+   if (is_snapshot (fd)) {
+      try {
+         load_snapshot (fd, stack);
+         stats::count_depth (stack.size());
+      }catch (ydc_error& failure) {
+         input_error (name, failure.what());
+      }
+      return;
+   }
+   scanner input (fd);
+   interpret (input, stack);
+}
+
+
+//
+// options -
+//    What scan_options found on the command line.
+//
+struct options {
+   string script;      //-f script, or "" if there is none
+   string snapshot;    //-s snapshot, or "" if there is none
+   string scratch;     //-T directory, or "" if there is none
+   size_t spill {0};   //-M bytes, or 0 if not given
+   bool batch {false}; //-b
+   size_t threads {0}; //-j threads, or 0 if not given
+};
+
+//bytes, with an optional K, M or G suffix for powers of 1024, or
+//0 if text is not a size
+size_t parse_size (const char* text) {
+   char* end = nullptr;
+   errno = 0;
+   unsigned long long size = strtoull (text, &end, 10);
+   if (errno != 0 or end == text or *text == '-') return 0;
+   int shift = 0;
+   switch (*end) {
+      case 'K': case 'k': shift = 10; ++end; break;
+      case 'M': case 'm': shift = 20; ++end; break;
+      case 'G': case 'g': shift = 30; ++end; break;
+   }
+   if (*end != '\0' or size > numeric_limits<size_t>::max() >> shift) {
+      return 0;
+   }
+   return size << shift;
+}
+
 //
 // scan_options
-//    Options analysis:  The only option is -Dflags.
+//    Options analysis:  -@flags sets debug flags, -b runs the inputs
+//    as a batch of independent jobs, -j N runs on N threads,
+//    -f script names a script to compile, -s snapshot names a file
+//    to save the stack to at the end, and -M size and -T directory
+//    spill numbers of at least size bytes to files in directory.
+//    -M is not a limit on memory: shorter numbers, and the blocks
+//    the limb pool keeps for reuse, stay in memory.
 //
-void scan_options (int argc, char** argv) {
+options scan_options (int argc, char** argv) {
+   options given;
    opterr = 0;
    for (;;) {
-      int option = getopt (argc, argv, "@:");
+      int option = getopt (argc, argv, "@:M:T:bf:j:s:");
       if (option == EOF) break;
       switch (option) {
          case '@':
             debugflags::setflags (optarg);
             break;
+         case 'M':
+            given.spill = parse_size (optarg);
+            if (given.spill == 0) {
+               error() << "-M " << optarg << ": invalid size" << endl;
+            }
+            break;
+         case 'T':
+            given.scratch = optarg;
+            break;
+         case 'b':
+            given.batch = true;
+            break;
+         case 'f':
+            given.script = optarg;
+            break;
+         case 'j': {
+            char* end = nullptr;
+            long threads = strtol (optarg, &end, 10);
+            if (*end != '\0' or threads < 1) {
+               error() << "-j " << optarg << ": invalid thread count"
+                       << endl;
+               break;
+            }
+            given.threads = threads;
+            break;
+            }
+         case 's':
+            given.snapshot = optarg;
+            break;
          default:
             error() << "-" << static_cast<char> (optopt)
                     << ": invalid option" << endl;
             break;
       }
    }
-   if (optind < argc) {
-      error() << "operand not permitted" << endl;
+   return given;
+}
+
+
+//
+// batch_inputs -
+//    The inputs of a batch.  An operand that is a directory stands
+//    for the regular files in it, in order of their names.
+//
+vector<string> batch_inputs (const vector<string>& operands) {
+   vector<string> inputs;
+   for (const string& name: operands) {
+      error_code failure;
+      if (not filesystem::is_directory (name, failure)) {
+         inputs.push_back (name);
+         continue;
+      }
+      vector<string> files;
+      for (const auto& entry:
+           filesystem::directory_iterator (name, failure)) {
+         if (entry.is_regular_file (failure)) {
+            files.push_back (entry.path().string());
+         }
+      }
+      if (failure) error() << name << ": " << failure.message() << endl;
+      sort (files.begin(), files.end());
+      inputs.insert (inputs.end(), files.begin(), files.end());
+   }
+   return inputs;
+}
+
+//
+// run_job -
+//    One batch job: the input is read on a stack of its own, with
+//    empty registers and k at 0, and then the script is run on what
+//    it left.  q ends just this job.
+//
+void run_job (const string& name, const program* script) {
+   for (optional<value>& saved: registers) saved.reset();
+   precision = 0;
+   int fd = name == "-" ? STDIN_FILENO : open (name.c_str(), O_RDONLY);
+   if (fd < 0) {
+      input_error (name, strerror (errno));
+      return;
+   }
+   value_stack stack;
+   try {
+      read_input (name, fd, stack);
+      if (script) script->run (stack, report);
+   }catch (ydc_quit&) {
+      // Intentionally left empty.
    }
+   if (fd != STDIN_FILENO) close (fd);
 }
 
-
+//
+// run_batch -
+//    Run the jobs on threads threads, each taking the next job not
+//    yet started.  A job's output and errors are captured, and
+//    written out once every job before it has been, so both are in
+//    input order however the jobs finish.  Operations inside a job
+//    run on the job's own thread.
+//
+void run_batch (const vector<string>& inputs, const program* script,
+                size_t threads) {
+   mutex lock;
+   vector<optional<printer::output>> outputs (inputs.size());
+   size_t written = 0;
+   atomic<size_t> next {0};
+   auto work = [&]() {
+      for (;;) {
+         size_t index = next++;
+         if (index >= inputs.size()) return;
+         printer::output output;
+         {
+            printer::capture guard (output);
+            run_job (inputs[index], script);
+         }
+         lock_guard<mutex> guard (lock);
+         outputs[index] = move (output);
+         for (; written < outputs.size() and outputs[written];
+              ++written) {
+            printer::append (*outputs[written]);
+            outputs[written] = printer::output();
+         }
+      }
+   };
+   vector<thread> workers;
+   threads = min (threads, inputs.size());
+   for (size_t index = 1; index < threads; ++index) {
+      workers.emplace_back (work);
+   }
+   work();
+   for (thread& worker: workers) worker.join();
+}
+
+
 //
 // Main function.
+//    The operands are input files, read in order, with "-" or no
+//    operands at all meaning the standard input.  Without a script
+//    they all share one stack.  With -f script, the script is
+//    compiled once and run after each input, and every input starts
+//    with an empty stack, so one program is applied to many inputs.
+//    With -b, every input is an independent job, with its own stack
+//    and registers, and the jobs run at the same time, as many as
+//    -j says or else one per hardware thread.  An input that is a
+//    snapshot is loaded rather than read, and -s saves the stack
+//    left at the end as one, so that runs can be chained.  With -M
+//    or -T, long numbers live in scratch files that the kernel can
+//    page out instead of swapping, and running out of room fails
+//    just the one operation.  The transforms of a long multiply are
+//    not arranged for this, so one that does not fit in memory
+//    thrashes.
 //
 int main (int argc, char** argv) {
    exec::execname (argv[0]);
-   scan_options (argc, argv);
-   bigint_stack operand_stack;
-   scanner input;
+   options given = scan_options (argc, argv);
+   if (given.spill > 0 or not given.scratch.empty()) {
+      //spill blocks of 64 MiB and up to $TMPDIR unless told otherwise
+      if (given.spill == 0) given.spill = size_t (1) << 26;
+      if (given.scratch.empty()) {
+         const char* tmpdir = getenv ("TMPDIR");
+         given.scratch = tmpdir != nullptr ? tmpdir : "/tmp";
+      }
+      pool_spill (given.scratch, given.spill);
+   }
+   if (not given.batch and given.threads > 0) {
+      set_worker_threads (given.threads);
+   }
+   unique_ptr<program> script;
+   if (not given.script.empty()) {
+      int fd = open (given.script.c_str(), O_RDONLY);
+      if (fd < 0) {
+         error() << given.script << ": " << strerror (errno) << endl;
+         return exec::status();
+      }
+      {
+         //folding must leave alone whatever depends on k, whose
+         //value is not known until the script runs
+         scanner input (fd);
+         precision = UNKNOWN_PRECISION;
+         script = make_unique<program> (input, lookup);
+         precision = 0;
+      }
+      close (fd);
+   }
+   vector<string> inputs (argv + optind, argv + argc);
+   if (inputs.empty()) inputs.push_back ("-");
+   if (given.batch) {
+      if (not given.snapshot.empty()) {
+         error() << "-s: jobs in a batch have no one stack to save"
+                 << endl;
+      }
+      size_t threads = given.threads;
+      if (threads == 0) threads = thread::hardware_concurrency();
+      if (threads == 0) threads = 1;
+      run_batch (batch_inputs (inputs), script.get(), threads);
+      return exec::status();
+   }
+   value_stack operand_stack;
    try {
-      for (;;) {
-         try {
-            token lexeme = input.scan();
-            switch (lexeme.symbol) {
-               case tsymbol::SCANEOF:
-                  throw ydc_quit();
-                  break;
-               case tsymbol::NUMBER:
-                  operand_stack.push (bigint (lexeme.lexinfo));
-                  break;
-               case tsymbol::OPERATOR: {
-                  char oper = lexeme.lexinfo[0];
-                  do_function (operand_stack, oper);
-                  break;
-                  }
-               default:
-                  assert (false);
-            }
-         }catch (ydc_error& error) {
-            cout << exec::execname() << ": " << error.what() << endl;
+      for (const string& name: inputs) {
+         int fd = name == "-" ? STDIN_FILENO
+                              : open (name.c_str(), O_RDONLY);
+         if (fd < 0) {
+            error() << name << ": " << strerror (errno) << endl;
+            continue;
          }
+         if (script) operand_stack.clear();
+         read_input (name, fd, operand_stack);
+         if (fd != STDIN_FILENO) close (fd);
+         if (script) script->run (operand_stack, report);
       }
    }catch (ydc_quit&) {
       // Intentionally left empty.
    }
+   if (not given.snapshot.empty()) {
+      try {
+         save_snapshot (given.snapshot, operand_stack);
+      }catch (ydc_error& failure) {
+         error() << failure.what() << endl;
+      }
+   }
    return exec::status();
 }
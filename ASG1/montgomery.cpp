@@ -0,0 +1,221 @@
+// $Id: montgomery.cpp,v 1.1 2020-02-17 09:48:30-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+#include "divide.h"
+#include "montgomery.h"
+#include "multiply.h"
+
+//mod 2^32 inverse of an odd limb, by Newton iteration
+static limb_t inverse_limb (limb_t odd) {
+   limb_t inverse = odd;
+   for (int iter = 0; iter < 5; ++iter) inverse *= 2 - odd * inverse;
+   return inverse;
+}
+
+//value mod modulus, padded to exactly modulus.size() limbs
+static limbvec reduce_padded (const limbvec& value,
+                              const limbvec& modulus) {
+   limbvec quotient, remainder;
+   divide (quotient, remainder, value, modulus);
+   remainder.resize (modulus.size(), 0);
+   return remainder;
+}
+
+montgomery::montgomery (const limbvec& odd_modulus):
+            modulus (odd_modulus),
+            neg_inverse_0 (-inverse_limb (odd_modulus[0])),
+            small (odd_modulus.size() < mul_thresholds::karatsuba) {
+   size_t k = modulus.size();
+   limbvec r_power (2 * k + 1, 0);
+   r_power[2 * k] = 1;
+   r_squared = reduce_padded (r_power, modulus);
+   if (small) return;
+
+   //Hensel lifting doubles the number of correct limbs each step:
+   //inverse = inverse * (2 - N * inverse) mod 2^(32 * size)
+   limbvec inverse {inverse_limb (modulus[0])};
+   limbvec product;
+   while (inverse.size() < k) {
+      size_t size = min (2 * inverse.size(), k);
+      ::multiply (product, modulus, inverse);
+      product.resize (size, 0);
+      //2 - product, mod 2^(32 * size)
+      limbvec two (size, 0);
+      two[0] = 2;
+      sub_n (product.data(), two.data(), product.data(), size);
+      limbvec next;
+      ::multiply (next, inverse, product);
+      next.resize (size, 0);
+      inverse = move (next);
+   }
+   //negate mod R
+   neg_inverse.assign (k, 0);
+   sub_n (neg_inverse.data(), neg_inverse.data(), inverse.data(), k);
+}
+
+//
+// reduce -
+//    result = product * R^-1 mod N for a product below N * R.  The
+//    small case runs the word by word reduction one limb at a time;
+//    the large case computes m = (product mod R) * -N^-1 mod R with
+//    the multiply tiers and then (product + m * N) / R.
+//
+
+void montgomery::reduce (limbvec& product, limbvec& result) const {
+   size_t k = modulus.size();
+   product.resize (2 * k + 1, 0);
+   if (small) {
+      limb_t* low = product.data();
+      for (size_t iter = 0; iter < k; ++iter) {
+         limb_t factor = low[iter] * neg_inverse_0;
+         limb_t carry = addmul_1 (low + iter, modulus.data(), k,
+                                  factor);
+         add_1 (low + iter + k, k + 1 - iter, carry);
+      }
+   }else {
+      limbvec factor;
+      limbvec low (product.begin(), product.begin() + k);
+      low.resize (normalized_size (low.data(), k));
+      if (not low.empty()) {
+         ::multiply (factor, low, neg_inverse);
+         factor.resize (k, 0);
+         factor.resize (normalized_size (factor.data(), k));
+      }
+      if (not factor.empty()) {
+         limbvec addend;
+         ::multiply (addend, factor, modulus);
+         add (product.data(), product.data(), product.size(),
+              addend.data(), addend.size());
+      }
+   }
+   //the low k limbs are now zero; the rest is below 2N
+   result.assign (product.begin() + k, product.begin() + 2 * k);
+   if (product[2 * k] != 0
+       or cmp_n (result.data(), modulus.data(), k) >= 0) {
+      sub_n (result.data(), result.data(), modulus.data(), k);
+   }
+}
+
+void montgomery::multiply (limbvec& result, const limbvec& a,
+                           const limbvec& b) const {
+   size_t k = modulus.size();
+   limbvec product (2 * k);
+   ::multiply (product.data(), a.data(), k, b.data(), k);
+   reduce (product, result);
+}
+
+limbvec montgomery::to_form (const limbvec& value) const {
+   limbvec result = reduce_padded (value, modulus);
+   multiply (result, result, r_squared);
+   return result;
+}
+
+limbvec montgomery::from_form (const limbvec& value) const {
+   limbvec product (value);
+   limbvec result;
+   reduce (product, result);
+   result.resize (normalized_size (result.data(), result.size()));
+   return result;
+}
+
+limbvec montgomery::one() const {
+   return to_form ({1});
+}
+
+static bool exponent_bit (const limbvec& exponent, size_t bit) {
+   return (exponent[bit / LIMB_BITS] >> (bit % LIMB_BITS)) & 1;
+}
+
+//
+// window_power -
+//    Left to right sliding window exponentiation.  mulmod (r, a, b)
+//    sets r to the reduced product of a and b, and may alias.  The
+//    table holds the odd powers base^1, base^3, ... base^(2^w - 1).
+//
+
+template <typename mulmod_t>
+static limbvec window_power (const limbvec& base, const limbvec& one,
+                             const limbvec& exponent, mulmod_t mulmod) {
+   size_t bits = exponent.size() * LIMB_BITS
+               - __builtin_clz (exponent.back());
+   size_t window = bits <= 24 ? 1 : bits <= 80 ? 3 : bits <= 240 ? 4
+                 : bits <= 672 ? 5 : 6;
+   vector<limbvec> table (size_t (1) << (window - 1));
+   table[0] = base;
+   if (table.size() > 1) {
+      limbvec square;
+      mulmod (square, base, base);
+      for (size_t iter = 1; iter < table.size(); ++iter) {
+         mulmod (table[iter], table[iter - 1], square);
+      }
+   }
+
+   limbvec result = one;
+   bool started = false;
+   for (size_t top = bits; top-- > 0;) {
+      if (not exponent_bit (exponent, top)) {
+         if (started) mulmod (result, result, result);
+         continue;
+      }
+      //the window runs from top down to the lowest set bit that is
+      //less than window bits away
+      size_t low = top >= window - 1 ? top - (window - 1) : 0;
+      while (not exponent_bit (exponent, low)) ++low;
+      size_t value = 0;
+      for (size_t bit = top + 1; bit-- > low;) {
+         value = value << 1 | exponent_bit (exponent, bit);
+         if (started) mulmod (result, result, result);
+      }
+      if (started) {
+         mulmod (result, result, table[value / 2]);
+      }else {
+         result = table[value / 2];
+         started = true;
+      }
+      top = low;
+   }
+   return result;
+}
+
+limbvec powmod (const limbvec& base, const limbvec& exponent,
+                const limbvec& modulus) {
+   if (modulus.size() == 1 and modulus[0] == 1) return {};
+   if (exponent.empty()) return {1};
+   if (modulus[0] & 1) {
+      montgomery context (modulus);
+      auto mulmod = [&context] (limbvec& result, const limbvec& a,
+                                const limbvec& b) {
+         context.multiply (result, a, b);
+      };
+      limbvec result = window_power (context.to_form (base),
+                                     context.one(), exponent, mulmod);
+      return context.from_form (result);
+   }
+   auto mulmod = [&modulus] (limbvec& result, const limbvec& a,
+                             const limbvec& b) {
+      limbvec product, quotient;
+      if (not a.empty() and not b.empty()) {
+         ::multiply (product, a, b);
+      }
+      divide (quotient, result, product, modulus);
+   };
+   limbvec reduced, quotient;
+   divide (quotient, reduced, base, modulus);
+   return window_power (reduced, {1}, exponent, mulmod);
+}
+
+limbvec power (const limbvec& base, const limbvec& exponent) {
+   if (exponent.empty()) return {1};
+   if (base.empty()) return {};
+   auto multiply = [] (limbvec& result, const limbvec& a,
+                       const limbvec& b) {
+      limbvec product;
+      ::multiply (product, a, b);
+      result.swap (product);
+   };
+   return window_power (base, {1}, exponent, multiply);
+}
@@ -0,0 +1,55 @@
+// $Id: montgomery.h,v 1.1 2020-02-17 09:48:30-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// montgomery -
+//    Modular exponentiation on limbs.  Odd moduli use Montgomery
+//    multiplication, which replaces each division by the modulus
+//    with multiplies and a shift by whole limbs.  Even moduli fall
+//    back to multiply and divide.  Either way the exponent is read
+//    left to right in sliding windows, and every intermediate is
+//    reduced, so memory stays proportional to the modulus.  Plain
+//    powers share the window loop.
+//
+
+#ifndef __MONTGOMERY_H__
+#define __MONTGOMERY_H__
+
+#include "limbs.h"
+
+//
+// montgomery -
+//    Context for one odd modulus N of k limbs, with R = 2^(32k).
+//    Values in Montgomery form are xR mod N, held as exactly k limbs.
+//
+
+class montgomery {
+   private:
+      limbvec modulus;
+      limbvec neg_inverse;   // -N^-1 mod R, for the large case
+      limbvec r_squared;     // R^2 mod N
+      limb_t neg_inverse_0;  // -N^-1 mod 2^32, for the small case
+      bool small;            // use word by word reduction
+      void reduce (limbvec& product, limbvec& result) const;
+   public:
+      explicit montgomery (const limbvec& odd_modulus);
+      limbvec to_form (const limbvec& value) const;
+      limbvec from_form (const limbvec& value) const;
+      limbvec one() const;
+      // result = a * b * R^-1 mod N; result may alias a or b
+      void multiply (limbvec& result, const limbvec& a,
+                     const limbvec& b) const;
+};
+
+// powmod -
+//    Normalized base^exponent mod modulus.  The modulus must not be
+//    empty.
+limbvec powmod (const limbvec& base, const limbvec& exponent,
+                const limbvec& modulus);
+
+// power -
+//    Normalized base^exponent, by the same sliding windows with
+//    nothing reduced.  Zero to the zero is one.
+limbvec power (const limbvec& base, const limbvec& exponent);
+
+#endif
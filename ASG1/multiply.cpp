@@ -0,0 +1,264 @@
+// $Id: multiply.cpp,v 1.1 2020-01-20 14:02:11-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+#include <utility>
+using namespace std;
+
+#include "multiply.h"
+#include "ntt.h"
+#include "stats.h"
+#include "workpool.h"
+
+size_t mul_thresholds::karatsuba = 40;
+size_t mul_thresholds::toom3 = 300;
+size_t mul_thresholds::ntt = 2500;
+size_t mul_thresholds::parallel = 400;
+
+//
+// signed_limbs -
+//    Sign and magnitude pair used by the Toom-3 evaluation and
+//    interpolation steps, whose intermediate values may go negative.
+//    The magnitude is always kept normalized.
+//
+
+struct signed_limbs {
+   limbvec mag;
+   bool neg {false};
+   signed_limbs() = default;
+   signed_limbs (const limb_t* a, size_t n):
+                 mag (a, a + normalized_size (a, n)) {}
+   void normalize() {
+      mag.resize (normalized_size (mag.data(), mag.size()));
+      if (mag.empty()) neg = false;
+   }
+};
+
+static int mag_cmp (const limbvec& a, const limbvec& b) {
+   if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+   return cmp_n (a.data(), b.data(), a.size());
+}
+
+//add magnitudes when the signs agree, otherwise subtract the
+//smaller from the larger and take the sign of the larger
+static signed_limbs signed_add (const signed_limbs& x,
+                                const signed_limbs& y) {
+   signed_limbs sum;
+   if (x.neg == y.neg) {
+      const signed_limbs& big = x.mag.size() < y.mag.size() ? y : x;
+      const signed_limbs& small = &big == &x ? y : x;
+      sum.mag = big.mag;
+      sum.mag.push_back (0);
+      add (sum.mag.data(), sum.mag.data(), sum.mag.size(),
+           small.mag.data(), small.mag.size());
+      sum.neg = x.neg;
+   }else {
+      bool x_bigger = mag_cmp (x.mag, y.mag) >= 0;
+      const signed_limbs& big = x_bigger ? x : y;
+      const signed_limbs& small = x_bigger ? y : x;
+      sum.mag = big.mag;
+      sub (sum.mag.data(), sum.mag.data(), sum.mag.size(),
+           small.mag.data(), small.mag.size());
+      sum.neg = big.neg;
+   }
+   sum.normalize();
+   return sum;
+}
+
+static signed_limbs signed_sub (const signed_limbs& x,
+                                signed_limbs y) {
+   y.neg = not y.neg;
+   return signed_add (x, y);
+}
+
+static signed_limbs signed_mul (const signed_limbs& x,
+                                const signed_limbs& y) {
+   signed_limbs product;
+   if (x.mag.empty() or y.mag.empty()) return product;
+   product.mag.resize (x.mag.size() + y.mag.size());
+   multiply (product.mag.data(), x.mag.data(), x.mag.size(),
+             y.mag.data(), y.mag.size());
+   product.neg = x.neg != y.neg;
+   product.normalize();
+   return product;
+}
+
+static signed_limbs signed_shl1 (signed_limbs x) {
+   x.mag.push_back (add_n (x.mag.data(), x.mag.data(),
+                           x.mag.data(), x.mag.size()));
+   x.normalize();
+   return x;
+}
+
+//exact division of the magnitude by a small divisor
+static signed_limbs signed_div (signed_limbs x, limb_t divisor) {
+   dlimb_t remainder = 0;
+   for (auto limb = x.mag.rbegin(); limb != x.mag.rend(); ++limb) {
+      dlimb_t interim = (remainder << LIMB_BITS) | *limb;
+      *limb = static_cast<limb_t>(interim / divisor);
+      remainder = interim % divisor;
+   }
+   x.normalize();
+   return x;
+}
+
+//add a nonnegative coefficient into r[offset..rn)
+static void add_at (limb_t* r, size_t rn, size_t offset,
+                    const signed_limbs& term) {
+   if (term.mag.empty()) return;
+   add (r + offset, r + offset, rn - offset,
+        term.mag.data(), term.mag.size());
+}
+
+//
+// mul_unbalanced -
+//    When a is at least twice as long as b, multiply b by a in
+//    blocks of bn limbs so that each subproduct is balanced.
+//
+
+static void mul_unbalanced (limb_t* r, const limb_t* a, size_t an,
+                            const limb_t* b, size_t bn) {
+   multiply (r, a, bn, b, bn);
+   limbvec block (2 * bn);
+   for (size_t pos = bn; pos < an; pos += bn) {
+      size_t len = min (bn, an - pos);
+      multiply (block.data(), a + pos, len, b, bn);
+      //r[pos..pos+bn) holds the high half of the previous block,
+      //r[pos+bn..) has not been written yet
+      copy_n (block.data() + bn, len, r + pos + bn);
+      limb_t carry = add_n (r + pos, r + pos, block.data(), bn);
+      add_1 (r + pos + bn, len, carry);
+   }
+}
+
+//
+// mul_karatsuba -
+//    Split both operands at m = an/2 limbs and form the product from
+//    three half size products: a0*b0, a1*b1 and (a0+a1)*(b0+b1).
+//    Requires bn <= an < 2*bn, so that b1 is never empty.
+//
+
+static void mul_karatsuba (limb_t* r, const limb_t* a, size_t an,
+                           const limb_t* b, size_t bn) {
+   bool square = a == b and an == bn;
+   size_t m = an / 2;
+   size_t ahigh = an - m;
+   size_t bhigh = bn - m;
+
+   limbvec asum (ahigh + 1);
+   asum[ahigh] = add (asum.data(), a + m, ahigh, a, m);
+   limbvec bsum;
+   if (not square) {
+      size_t blen = max (m, bhigh);
+      bsum.resize (blen + 1);
+      bsum[blen] = bhigh >= m
+                 ? add (bsum.data(), b + m, bhigh, b, m)
+                 : add (bsum.data(), b, m, b + m, bhigh);
+   }
+   const limbvec& bmid = square ? asum : bsum;
+
+   //z0 and z2 go straight into the low and high parts of r, and
+   //the three products are independent
+   limbvec mid (asum.size() + bmid.size());
+   parallel_invoke_if (bn >= mul_thresholds::parallel,
+      [&]() { multiply (r, a, m, b, m); },
+      [&]() { multiply (r + 2 * m, a + m, ahigh, b + m, bhigh); },
+      [&]() {
+         multiply (mid.data(), asum.data(), asum.size(),
+                   bmid.data(), bmid.size());
+      });
+
+   //z1 = (a0+a1)*(b0+b1) - z0 - z2
+   sub (mid.data(), mid.data(), mid.size(), r, 2 * m);
+   sub (mid.data(), mid.data(), mid.size(), r + 2 * m, ahigh + bhigh);
+   size_t midlen = normalized_size (mid.data(), mid.size());
+   add (r + m, r + m, an + bn - m, mid.data(), midlen);
+}
+
+//
+// mul_toom3 -
+//    Split both operands into three pieces of k limbs, evaluate at
+//    0, 1, -1, -2 and infinity, multiply pointwise, and interpolate
+//    with Bodrato's sequence.  Requires 2*k < bn <= an.
+//
+
+static void mul_toom3 (limb_t* r, const limb_t* a, size_t an,
+                       const limb_t* b, size_t bn) {
+   size_t k = (an + 2) / 3;
+   signed_limbs a0 (a, k), a1 (a + k, k), a2 (a + 2 * k, an - 2 * k);
+   signed_limbs b0 (b, k), b1 (b + k, k), b2 (b + 2 * k, bn - 2 * k);
+
+   auto evaluate = [] (const signed_limbs& x0, const signed_limbs& x1,
+                       const signed_limbs& x2) {
+      struct { signed_limbs p1, pm1, pm2; } points;
+      signed_limbs even = signed_add (x0, x2);
+      points.p1 = signed_add (even, x1);
+      points.pm1 = signed_sub (even, x1);
+      signed_limbs odd_sum = signed_add (points.pm1, x2);
+      points.pm2 = signed_sub (signed_shl1 (odd_sum), x0);
+      return points;
+   };
+   auto pa = evaluate (a0, a1, a2);
+   bool square = a == b and an == bn;
+   auto pb = square ? pa : evaluate (b0, b1, b2);
+
+   signed_limbs r0, r1, rm1, rm2, rinf;
+   parallel_invoke_if (bn >= mul_thresholds::parallel,
+      [&]() { r0 = signed_mul (a0, b0); },
+      [&]() { r1 = signed_mul (pa.p1, pb.p1); },
+      [&]() { rm1 = signed_mul (pa.pm1, pb.pm1); },
+      [&]() { rm2 = signed_mul (pa.pm2, pb.pm2); },
+      [&]() { rinf = signed_mul (a2, b2); });
+
+   signed_limbs r3 = signed_div (signed_sub (rm2, r1), 3);
+   r1 = signed_div (signed_sub (r1, rm1), 2);
+   signed_limbs r2 = signed_sub (rm1, r0);
+   r3 = signed_add (signed_div (signed_sub (r2, r3), 2),
+                    signed_shl1 (rinf));
+   r2 = signed_sub (signed_add (r2, r1), rinf);
+   r1 = signed_sub (r1, r3);
+
+   size_t rn = an + bn;
+   fill_n (r, rn, 0);
+   add_at (r, rn, 0, r0);
+   add_at (r, rn, k, r1);
+   add_at (r, rn, 2 * k, r2);
+   add_at (r, rn, 3 * k, r3);
+   add_at (r, rn, 4 * k, rinf);
+}
+
+void multiply (limb_t* r, const limb_t* a, size_t an,
+               const limb_t* b, size_t bn) {
+   if (an < bn) {
+      swap (a, b);
+      swap (an, bn);
+   }
+   //below 4 limbs the Karatsuba middle product is no smaller than
+   //the original, so the recursion would never terminate
+   if (bn < max<size_t> (mul_thresholds::karatsuba, 4)) {
+      stats::count_tier (tier::MUL_BASECASE);
+      mul_basecase (r, a, an, b, bn);
+   }else if (bn >= mul_thresholds::ntt and ntt_fits (an, bn)) {
+      stats::count_tier (tier::MUL_NTT);
+      mul_ntt (r, a, an, b, bn);
+   }else if (an >= 2 * bn) {
+      stats::count_tier (tier::MUL_UNBALANCED);
+      mul_unbalanced (r, a, an, b, bn);
+   }else if (bn >= mul_thresholds::toom3 and bn > 2 * ((an + 2) / 3)) {
+      stats::count_tier (tier::MUL_TOOM3);
+      mul_toom3 (r, a, an, b, bn);
+   }else {
+      stats::count_tier (tier::MUL_KARATSUBA);
+      mul_karatsuba (r, a, an, b, bn);
+   }
+}
+
+void multiply (limbvec& product, const limbvec& left,
+               const limbvec& right) {
+   product.clear();
+   if (left.empty() or right.empty()) return;
+   product.resize (left.size() + right.size());
+   multiply (product.data(), left.data(), left.size(),
+             right.data(), right.size());
+   product.resize (normalized_size (product.data(), product.size()));
+}
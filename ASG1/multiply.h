@@ -0,0 +1,49 @@
+// $Id: multiply.h,v 1.1 2020-01-20 14:02:11-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// multiply -
+//    Size dispatched limb multiplication.  Operands shorter than
+//    karatsuba limbs use the schoolbook loop, operands of at least
+//    toom3 limbs use Toom-Cook 3-way, and the Karatsuba method is
+//    used in between.  When the shorter operand has at least ntt
+//    limbs the product is done by number theoretic transform, unless
+//    it is too long for one transform, in which case the Toom-3 and
+//    Karatsuba splits cut it down until the pieces fit.  The
+//    recursion dispatches again at each level, so a large Toom-3
+//    product bottoms out in Karatsuba and then schoolbook
+//    subproducts.
+//
+
+#ifndef __MULTIPLY_H__
+#define __MULTIPLY_H__
+
+#include "limbs.h"
+
+// mul_thresholds -
+//    Crossover points in limbs, measured by `make tune'.  They are
+//    static members rather than constants so that tunemul can move
+//    them while it times each algorithm.  With more than one worker
+//    thread, the subproducts of a Karatsuba or Toom-3 step whose
+//    shorter operand has at least parallel limbs run in parallel.
+
+class mul_thresholds {
+   public:
+      static size_t karatsuba;
+      static size_t toom3;
+      static size_t ntt;
+      static size_t parallel;
+};
+
+// multiply -
+//    r[0..an+bn) = a[0..an) * b[0..bn).  r must not alias a or b.
+//    Both operands must be nonempty.
+void multiply (limb_t* r, const limb_t* a, size_t an,
+               const limb_t* b, size_t bn);
+
+// multiply -
+//    Normalized product of two normalized limb vectors.
+void multiply (limbvec& product, const limbvec& left,
+               const limbvec& right);
+
+#endif
@@ -0,0 +1,216 @@
+// $Id: ntt.cpp,v 1.1 2020-01-27 10:41:36-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+#include <utility>
+#include <vector>
+using namespace std;
+
+#include "ntt.h"
+#include "workpool.h"
+
+__extension__ using uint128_t = unsigned __int128;
+
+using residue_t = uint64_t;
+//from the limb pool like limb vectors, so a long transform may be
+//a spilled block, though its passes are not blocked to read it in
+//order
+using residues = vector<residue_t, pool_allocator<residue_t>>;
+
+//With more than one worker thread, each transform pass is cut into
+//pieces of this many butterflies that run in parallel.
+constexpr size_t PARALLEL_BUTTERFLIES = 1 << 14;
+
+//
+// ntt_prime -
+//    Arithmetic modulo a prime of the form c * 2^k + 1 below 2^62
+//    with the given primitive root.  Products are reduced with
+//    Montgomery's method, R = 2^64.  The forward transform is
+//    decimation in frequency and leaves its output in bit reversed
+//    order, and the inverse is decimation in time and takes its
+//    input that way, so no bit reversal pass is needed between them.
+//
+
+template <residue_t MOD, residue_t ROOT>
+struct ntt_prime {
+   static constexpr residue_t modulus = MOD;
+
+   static constexpr residue_t mul_slow (residue_t a, residue_t b) {
+      uint128_t product = static_cast<uint128_t>(a) * b;
+      return static_cast<residue_t>(product % MOD);
+   }
+
+   static constexpr residue_t power (residue_t base, residue_t exp) {
+      residue_t result = 1;
+      residue_t square = base % MOD;
+      for (; exp > 0; exp >>= 1) {
+         if (exp & 1) result = mul_slow (result, square);
+         square = mul_slow (square, square);
+      }
+      return result;
+   }
+
+   static constexpr residue_t inverse (residue_t a) {
+      return power (a, MOD - 2);
+   }
+
+   //-MOD^-1 mod 2^64, by Newton iteration on the 2-adic inverse
+   static constexpr residue_t neg_inverse() {
+      residue_t inv = MOD;
+      for (int iter = 0; iter < 6; ++iter) inv *= 2 - MOD * inv;
+      return -inv;
+   }
+   static constexpr residue_t NEG_INV = neg_inverse();
+   //R^2 mod MOD is 2^128 mod MOD, which is -MOD mod MOD in 128 bits
+   static constexpr residue_t R2 = static_cast<residue_t>(
+          -static_cast<uint128_t>(MOD) % MOD);
+
+   //a * b * R^-1 mod MOD; with MOD < 2^62 the sum below is < 2^127
+   static residue_t mont_mul (residue_t a, residue_t b) {
+      uint128_t product = static_cast<uint128_t>(a) * b;
+      residue_t factor = static_cast<residue_t>(product) * NEG_INV;
+      residue_t result = static_cast<residue_t>(
+            (product + static_cast<uint128_t>(factor) * MOD) >> 64);
+      return result >= MOD ? result - MOD : result;
+   }
+
+   static residue_t to_mont (residue_t a) {
+      return mont_mul (a, R2);
+   }
+
+   //powers 0..half-1 of a root of order 2*half, in Montgomery form
+   static void twiddles (residues& table, size_t half, bool invert) {
+      residue_t step = power (ROOT, (MOD - 1) / (2 * half));
+      if (invert) step = inverse (step);
+      step = to_mont (step);
+      table[0] = to_mont (1);
+      for (size_t iter = 1; iter < half; ++iter) {
+         table[iter] = mont_mul (table[iter - 1], step);
+      }
+   }
+
+   static residue_t add (residue_t a, residue_t b) {
+      return a + b >= MOD ? a + b - MOD : a + b;
+   }
+
+   static residue_t sub (residue_t a, residue_t b) {
+      return a >= b ? a - b : a + MOD - b;
+   }
+
+   //The butterflies of one pass are independent.  Number them
+   //0..len/2 in block order; butterfly j of a pass with the given
+   //half works on index iter = j % half of the block at 2*(j-iter).
+   template <typename butterfly>
+   static void butterfly_pass (residues& data, size_t half,
+                               const butterfly& step) {
+      parallel_for (0, data.size() / 2, PARALLEL_BUTTERFLIES,
+                    [&] (size_t first, size_t last) {
+         for (size_t pos = first; pos < last; ) {
+            size_t iter = pos % half;
+            residue_t* low = data.data() + 2 * (pos - iter);
+            size_t stop = min (half, iter + (last - pos));
+            pos += stop - iter;
+            for (; iter < stop; ++iter) step (low + iter, half, iter);
+         }
+      });
+   }
+
+   //natural order in, bit reversed order out
+   static void forward (residues& data) {
+      size_t len = data.size();
+      residues table (len / 2);
+      for (size_t half = len / 2; half >= 1; half >>= 1) {
+         twiddles (table, half, false);
+         butterfly_pass (data, half,
+                         [&] (residue_t* low, size_t offset,
+                              size_t iter) {
+            residue_t even = low[0];
+            residue_t odd = low[offset];
+            low[0] = add (even, odd);
+            low[offset] = mont_mul (sub (even, odd), table[iter]);
+         });
+      }
+   }
+
+   //bit reversed order in, natural order out, not yet scaled by 1/len
+   static void inverse_transform (residues& data) {
+      size_t len = data.size();
+      residues table (len / 2);
+      for (size_t half = 1; half < len; half <<= 1) {
+         twiddles (table, half, true);
+         butterfly_pass (data, half,
+                         [&] (residue_t* low, size_t offset,
+                              size_t iter) {
+            residue_t even = low[0];
+            residue_t odd = mont_mul (low[offset], table[iter]);
+            low[0] = add (even, odd);
+            low[offset] = sub (even, odd);
+         });
+      }
+   }
+
+   //cyclic convolution of two limb sequences modulo MOD
+   static residues convolve (const limb_t* a, size_t an,
+                             const limb_t* b, size_t bn, size_t len) {
+      residues fleft (a, a + an);
+      fleft.resize (len, 0);
+      if (a == b and an == bn) {
+         forward (fleft);
+         for (auto& value: fleft) value = mont_mul (value, value);
+      }else {
+         residues fright (b, b + bn);
+         fright.resize (len, 0);
+         parallel_invoke_if (true, [&]() { forward (fleft); },
+                                   [&]() { forward (fright); });
+         for (size_t iter = 0; iter < len; ++iter) {
+            fleft[iter] = mont_mul (fleft[iter], fright[iter]);
+         }
+      }
+      //the pointwise products carry an extra R^-1, so scale by
+      //R / len, which is 1/len * R^2 in Montgomery form
+      inverse_transform (fleft);
+      residue_t scale = to_mont (to_mont (inverse (len % MOD)));
+      for (auto& value: fleft) value = mont_mul (value, scale);
+      return fleft;
+   }
+};
+
+using prime1 = ntt_prime<4179340454199820289, 3>;   // 29 * 2^57 + 1
+using prime2 = ntt_prime<2485986994308513793, 5>;   // 69 * 2^55 + 1
+
+//the shorter 2-power factor of the two primes bounds the length
+constexpr size_t MAX_TRANSFORM = size_t (1) << 55;
+
+bool ntt_fits (size_t an, size_t bn) {
+   return an + bn <= MAX_TRANSFORM;
+}
+
+void mul_ntt (limb_t* r, const limb_t* a, size_t an,
+              const limb_t* b, size_t bn) {
+   size_t count = an + bn - 1;
+   size_t len = 1;
+   while (len < count) len <<= 1;
+
+   residues conv1, conv2;
+   parallel_invoke_if (true,
+      [&]() { conv1 = prime1::convolve (a, an, b, bn, len); },
+      [&]() { conv2 = prime2::convolve (a, an, b, bn, len); });
+
+   //Garner's algorithm: x = c1 + p1 * ((c2 - c1) / p1 mod p2)
+   constexpr residue_t p1 = prime1::modulus;
+   constexpr residue_t p2 = prime2::modulus;
+   constexpr residue_t inv_p1_mod_p2 = prime2::inverse (p1 % p2);
+
+   uint128_t carry = 0;
+   for (size_t iter = 0; iter < an + bn; ++iter) {
+      if (iter < count) {
+         residue_t c1 = conv1[iter];
+         residue_t t2 = prime2::mul_slow (
+                        prime2::sub (conv2[iter], c1 % p2),
+                        inv_p1_mod_p2);
+         carry += c1 + static_cast<uint128_t>(p1) * t2;
+      }
+      r[iter] = static_cast<limb_t>(carry);
+      carry >>= LIMB_BITS;
+   }
+}
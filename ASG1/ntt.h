@@ -0,0 +1,31 @@
+// $Id: ntt.h,v 1.1 2020-01-27 10:41:36-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// ntt -
+//    Number theoretic transform multiplication.  The limb sequences
+//    are convolved modulo two primes just below 2^62.  A convolution
+//    coefficient is less than 2^64 times the transform length, which
+//    is well below the product of the two primes, so Garner's CRT
+//    recovers it exactly.  Everything is integer arithmetic, so the
+//    result is deterministic.
+//
+
+#ifndef __NTT_H__
+#define __NTT_H__
+
+#include "limbs.h"
+
+// ntt_fits -
+//    True when an an by bn limb product fits in the largest
+//    transform that both primes support, 2^55 points, the limit of
+//    69 * 2^55 + 1.
+bool ntt_fits (size_t an, size_t bn);
+
+// mul_ntt -
+//    r[0..an+bn) = a[0..an) * b[0..bn).  r must not alias a or b,
+//    and ntt_fits (an, bn) must hold.
+void mul_ntt (limb_t* r, const limb_t* a, size_t an,
+              const limb_t* b, size_t bn);
+
+#endif
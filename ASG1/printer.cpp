@@ -0,0 +1,90 @@
+// $Id: printer.cpp,v 1.1 2020-02-24 14:31:08-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <cerrno>
+#include <iostream>
+using namespace std;
+
+#include <unistd.h>
+
+#include "printer.h"
+
+string printer::buffer;
+bool printer::interactive = isatty (STDOUT_FILENO);
+thread_local printer::output* printer::captured = nullptr;
+
+//the buffer must reach the terminal or file even if main never
+//gets to flush it, e.g. when exit() is called
+static struct flush_at_exit {
+   ~flush_at_exit() { printer::flush(); }
+} flusher;
+
+printer::capture::capture (output& into): saved (captured) {
+   captured = &into;
+}
+
+printer::capture::~capture() {
+   captured = saved;
+}
+
+string& printer::target() {
+   return captured != nullptr ? captured->text : buffer;
+}
+
+void printer::line_done() {
+   target() += '\n';
+   if (captured != nullptr) return;
+   if (interactive or buffer.size() >= FLUSH_SIZE) flush();
+}
+
+void printer::print (const bigdecimal& value) {
+   value.print (target());
+   line_done();
+}
+
+void printer::print (string_view text) {
+   target() += text;
+   line_done();
+}
+
+void printer::append (string_view text) {
+   target() += text;
+   if (captured != nullptr) return;
+   if (interactive or buffer.size() >= FLUSH_SIZE) flush();
+}
+
+//standard output is flushed before each error, so that the two
+//come out in order when they go to the same place
+void printer::append (const output& captured_output) {
+   string_view text = captured_output.text;
+   size_t done = 0;
+   for (const auto& [at, message]: captured_output.errors) {
+      append (text.substr (done, at - done));
+      flush();
+      cerr << message;
+      done = at;
+   }
+   append (text.substr (done));
+}
+
+void printer::error (const string& message) {
+   if (captured != nullptr) {
+      captured->errors.emplace_back (captured->text.size(), message);
+   }else {
+      cerr << message;
+   }
+}
+
+//a short write, say to a pipe, just means go around again; any
+//other error loses the output, as it would with cout
+void printer::flush() {
+   size_t done = 0;
+   while (done < buffer.size()) {
+      ssize_t wrote = write (STDOUT_FILENO, buffer.data() + done,
+                             buffer.size() - done);
+      if (wrote < 0 and errno == EINTR) continue;
+      if (wrote <= 0) break;
+      done += wrote;
+   }
+   buffer.clear();
+}
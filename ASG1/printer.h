@@ -0,0 +1,82 @@
+// $Id: printer.h,v 1.1 2020-02-24 14:31:08-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// printer -
+//    Buffered standard output for ydc.  Each number is formatted
+//    whole, line breaks included, straight into one large buffer.
+//    The buffer is written to file descriptor 1 when it fills, at
+//    exit, and after every line when standard output is a terminal,
+//    so a person at the keyboard still sees each answer at once.
+//    Everything main prints to cout goes through here so that it
+//    stays in order.  DEBUGF traces still go to cout directly.
+//
+//    A thread may instead capture what it prints into an output of
+//    its own, which is how batch jobs running at the same time keep
+//    their outputs apart.  An output keeps the error messages
+//    printed while it was captured too, with where each fell in the
+//    text, so appending it later writes each one to standard error
+//    in its place.  The shared buffer itself is for one thread at a
+//    time.
+//
+
+#ifndef __PRINTER_H__
+#define __PRINTER_H__
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+using namespace std;
+
+#include "bigdecimal.h"
+
+class printer {
+   public:
+      // output -
+      //    What a capture collects: the text, and each error message
+      //    with the length the text had when it came.
+      struct output {
+         string text;
+         vector<pair<size_t, string>> errors;
+      };
+   private:
+      static constexpr size_t FLUSH_SIZE = 1 << 20;
+      static string buffer;
+      static bool interactive;
+      static thread_local output* captured;
+      static string& target();
+      static void line_done();
+   public:
+      // capture -
+      //    While one is alive, whatever this thread prints is
+      //    kept in into instead.
+      class capture {
+         private:
+            output* saved;
+         public:
+            explicit capture (output& into);
+            ~capture();
+            capture (const capture&) = delete;
+            capture& operator= (const capture&) = delete;
+      };
+      // print -
+      //    Append the value or text and a newline.
+      static void print (const bigdecimal& value);
+      static void print (string_view text);
+      // append -
+      //    Append text as it is, newlines and all.  A captured
+      //    output is appended with its errors written out where
+      //    they fell.
+      static void append (string_view text);
+      static void append (const output& captured_output);
+      // error -
+      //    Write a whole error message to standard error, or keep it
+      //    in the capture.
+      static void error (const string& message);
+      // flush -
+      //    Write out everything buffered so far.
+      static void flush();
+};
+
+#endif
@@ -0,0 +1,108 @@
+// $Id: program.cpp,v 1.1 2020-02-28 10:14:36-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <cassert>
+#include <new>
+using namespace std;
+
+#include "debug.h"
+#include "program.h"
+#include "stats.h"
+
+//A constant push is an instruction without a function.  Constants
+//are pooled in the order of their pushes, so the pushes at the end
+//of the code always use the constants at the end of the pool.
+void program::push (const value& constant) {
+   code.push_back ({nullptr, static_cast<uint32_t> (constants.size()),
+                    '\0', '\0'});
+   constants.push_back (constant);
+   //a folded pending product is worked out now, since the constant
+   //may be shared by jobs running at the same time
+   if (constant.is_number()) constants.back().number();
+}
+
+void perform (void (*function) (value_stack&, const char),
+              value_stack& stack, char symbol, char oper) {
+   size_t bits = 0;
+   if (stack.size() > 0) bits = stack.top().bit_length();
+   stats::timer timing (symbol, bits, stack.size());
+   try {
+      function (stack, oper);
+      stats::count_depth (stack.size());
+   }catch (bad_alloc&) {
+      //only this operation is abandoned, and the run goes on
+      throw ydc_error ("out of memory");
+   }
+}
+
+void program::fold (const operation& op, char symbol, char oper) {
+   size_t operands = op.folds;
+   bool foldable = operands > 0 and code.size() >= operands;
+   for (size_t back = 1; foldable and back <= operands; ++back) {
+      foldable = code[code.size() - back].function == nullptr;
+   }
+   if (foldable) {
+      value_stack scratch;
+      for (size_t index = constants.size() - operands;
+           index < constants.size(); ++index) {
+         scratch.push (constants[index]);
+      }
+      try {
+         op.function (scratch, oper);
+         code.resize (code.size() - operands);
+         constants.resize (constants.size() - operands);
+         //the stack iterates from the top down
+         vector<value> results (scratch.begin(), scratch.end());
+         for (auto result = results.rbegin(); result != results.rend();
+              ++result) {
+            push (*result);
+         }
+         DEBUGF ('c', "folded '" << symbol << "' to " << results.size()
+                      << " constants");
+         return;
+      }catch (ydc_error&) {
+         //leave the error to happen at run time
+      }
+   }
+   code.push_back ({op.function, 0, symbol, oper});
+}
+
+program::program (scanner& input, operation (*lookup) (char)) {
+   for (;;) {
+      token lexeme = input.scan();
+      switch (lexeme.symbol) {
+         case tsymbol::SCANEOF:
+            DEBUGF ('c', code.size() << " instructions, "
+                         << constants.size() << " constants");
+            return;
+         case tsymbol::NUMBER:
+            push (value (bigdecimal (lexeme.lexinfo)));
+            break;
+         case tsymbol::STRING:
+            push (value (lexeme.lexinfo));
+            break;
+         case tsymbol::OPERATOR:
+            fold (lookup (lexeme.lexinfo[0]), lexeme.lexinfo[0],
+                  lexeme.lexinfo.back());
+            break;
+         default:
+            assert (false);
+      }
+   }
+}
+
+void program::run (value_stack& stack,
+                   void (*report) (const ydc_error&)) const {
+   for (const instruction& step: code) {
+      try {
+         if (step.function == nullptr) {
+            stack.push (constants[step.constant]);
+            stats::count_depth (stack.size());
+         }else {
+            perform (step.function, stack, step.symbol, step.oper);
+         }
+      }catch (ydc_error& error) {
+         report (error);
+      }
+   }
+}
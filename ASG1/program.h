@@ -0,0 +1,74 @@
+// $Id: program.h,v 1.1 2020-02-28 10:14:36-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// program -
+//    A ydc script compiled once so that it can be run many times.
+//    Numbers and strings are put in a constant pool when the script
+//    is compiled, and each operator is looked up once and kept as a
+//    pointer to its function.  Running the program then neither
+//    scans text nor dispatches on characters.
+//
+//    Constants are folded while compiling.  When an operation that
+//    neither prints nor depends on anything but its operands follows
+//    enough pushes of constants, it is run then and there, and the
+//    pushes and the operation are replaced by pushes of what it left.
+//    So "2 4096 ^" costs one push on every run.  An operation that
+//    fails, such as a division by zero, is not folded and fails at
+//    run time as it would have without compiling.
+//
+
+#ifndef __PROGRAM_H__
+#define __PROGRAM_H__
+
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+#include "scanner.h"
+#include "util.h"
+#include "value.h"
+
+// perform -
+//    Call function (stack, oper) for the operator character symbol,
+//    counting it for the Y statistics.
+void perform (void (*function) (value_stack&, const char),
+              value_stack& stack, char symbol, char oper);
+
+// operation -
+//    What an operator character does.  function is called with the
+//    stack and the character, or for an operator that names a
+//    register, with the register.  An operation with folds > 0 takes
+//    that many operands from the stack, has no other effect, and may
+//    be folded when they are all constants.
+struct operation {
+   void (*function) (value_stack&, const char);
+   size_t folds;
+};
+
+class program {
+   private:
+      struct instruction {
+         void (*function) (value_stack&, const char);
+         uint32_t constant;
+         char symbol;
+         char oper;
+      };
+      vector<value> constants;
+      vector<instruction> code;
+      void push (const value& constant);
+      void fold (const operation& op, char symbol, char oper);
+   public:
+      // program -
+      //    Compile everything input has to the end of file, using
+      //    lookup to find what each operator character does.
+      program (scanner& input, operation (*lookup) (char));
+      // run -
+      //    Execute the program on stack.  A ydc_error is passed to
+      //    report and the program goes on with the next instruction.
+      void run (value_stack& stack,
+                void (*report) (const ydc_error&)) const;
+      size_t size() const { return code.size(); }
+};
+
+#endif
@@ -0,0 +1,173 @@
+// $Id: radix.cpp,v 1.1 2020-02-10 11:05:47-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <vector>
+using namespace std;
+
+#include "divide.h"
+#include "multiply.h"
+#include "radix.h"
+#include "workpool.h"
+
+//Decimal digits are converted to and from limbs in chunks of
+//CHUNK_DIGITS digits, the largest power of 10 that fits in a limb.
+const limb_t CHUNK_BASE = 1000000000;
+const size_t CHUNK_DIGITS = 9;
+
+//Below these sizes the quadratic chunk loops are faster than
+//splitting, since the split costs a full multiply or divide.
+const size_t PARSE_SPLIT_DIGITS = 2000;
+const size_t PRINT_SPLIT_LIMBS = 60;
+
+//With more than one worker thread, the two halves of a split at
+//least this big are converted in parallel.
+const size_t PARALLEL_LIMBS = 2000;
+const size_t PARALLEL_DIGITS = PARALLEL_LIMBS * CHUNK_DIGITS;
+
+//The powers live in a deque so that a reference handed out stays
+//valid as the table grows.  Squares are computed outside the lock,
+//since multiply may fork tasks that themselves need a power.
+const limbvec& decimal_power (size_t level) {
+   static mutex lock;
+   static deque<limbvec> powers {{CHUNK_BASE}};
+   unique_lock<mutex> guard (lock);
+   while (powers.size() <= level) {
+      size_t next = powers.size();
+      const limbvec& root = powers.back();
+      guard.unlock();
+      limbvec square;
+      multiply (square, root, root);
+      guard.lock();
+      if (powers.size() == next) powers.push_back (move (square));
+   }
+   return powers[level];
+}
+
+static size_t level_digits (size_t level) {
+   return CHUNK_DIGITS << level;
+}
+
+//the cached powers are multiplied smallest first, so each multiply
+//is by a factor at least as long as the product so far
+limbvec power_of_ten (size_t exponent) {
+   limb_t small = 1;
+   for (size_t iter = 0; iter < exponent % CHUNK_DIGITS; ++iter) {
+      small *= 10;
+   }
+   limbvec result {small};
+   size_t chunks = exponent / CHUNK_DIGITS;
+   for (size_t level = 0; chunks != 0; ++level, chunks >>= 1) {
+      if ((chunks & 1) == 0) continue;
+      limbvec product;
+      multiply (product, result, decimal_power (level));
+      result.swap (product);
+   }
+   return result;
+}
+
+//value = value * 10^9 + chunk for each chunk of digits, leftmost
+//first, so the first chunk takes the leftover digits
+static limbvec parse_chunks (const char* digits, size_t n) {
+   limbvec value;
+   value.reserve (n / CHUNK_DIGITS + 1);
+   size_t chunk = n % CHUNK_DIGITS;
+   if (chunk == 0) chunk = CHUNK_DIGITS;
+   for (size_t pos = 0; pos < n; pos += chunk, chunk = CHUNK_DIGITS) {
+      limb_t addend = 0;
+      limb_t scale = 1;
+      for (size_t iter = pos; iter < pos + chunk; ++iter) {
+         addend = addend * 10 + (digits[iter] - '0');
+         scale *= 10;
+      }
+      limb_t carry = mul_1 (value.data(), value.data(), value.size(),
+                            scale);
+      carry += add_1 (value.data(), value.size(), addend);
+      if (carry != 0) value.push_back (carry);
+   }
+   value.resize (normalized_size (value.data(), value.size()));
+   return value;
+}
+
+limbvec from_decimal (const char* digits, size_t n) {
+   if (n <= PARSE_SPLIT_DIGITS) return parse_chunks (digits, n);
+   //split off the largest power of 10^9 block that leaves a
+   //nonempty high part
+   size_t level = 0;
+   while (level_digits (level + 1) < n) ++level;
+   size_t low_digits = level_digits (level);
+   const limbvec& power = decimal_power (level);
+   limbvec high, low;
+   parallel_invoke_if (n >= PARALLEL_DIGITS,
+      [&]() { high = from_decimal (digits, n - low_digits); },
+      [&]() {
+         low = from_decimal (digits + n - low_digits, low_digits);
+      });
+   if (high.empty()) return low;
+   limbvec value;
+   multiply (value, high, power);
+   value.resize (max (value.size(), low.size()) + 1, 0);
+   add (value.data(), value.data(), value.size(),
+        low.data(), low.size());
+   value.resize (normalized_size (value.data(), value.size()));
+   return value;
+}
+
+//write the digits of value in chunks of CHUNK_DIGITS, ending just
+//before end, and return where the leftmost chunk starts
+static char* print_chunks (limbvec value, char* end) {
+   while (not value.empty()) {
+      limb_t chunk = divrem_1 (value.data(), value.data(),
+                               value.size(), CHUNK_BASE);
+      value.resize (normalized_size (value.data(), value.size()));
+      for (size_t iter = 0; iter < CHUNK_DIGITS; ++iter) {
+         *--end = static_cast<char>('0' + chunk % 10);
+         chunk /= 10;
+      }
+   }
+   return end;
+}
+
+//write exactly level_digits (level) digits of value, which must be
+//below decimal_power (level), zero padded on the left
+static void print_digits (const limbvec& value, size_t level,
+                          char* out) {
+   if (level == 0 or value.size() < PRINT_SPLIT_LIMBS) {
+      fill (out, print_chunks (value, out + level_digits (level)), '0');
+      return;
+   }
+   limbvec high, low;
+   divide (high, low, value, decimal_power (level - 1));
+   parallel_invoke_if (value.size() >= PARALLEL_LIMBS,
+      [&]() { print_digits (high, level - 1, out); },
+      [&]() {
+         print_digits (low, level - 1, out + level_digits (level - 1));
+      });
+}
+
+string to_decimal (const limbvec& value) {
+   if (value.empty()) return "0";
+   if (value.size() < PRINT_SPLIT_LIMBS) {
+      string digits (value.size() * 10 + CHUNK_DIGITS, '0');
+      char* first = print_chunks (value, digits.data() + digits.size());
+      digits.erase (0, first - digits.data());
+      digits.erase (0, digits.find_first_not_of ('0'));
+      return digits;
+   }
+   //a limb holds a little over 9 digits, so splitting at a power
+   //of at most 9/2 digits per limb leaves a nonempty high half
+   size_t level = 0;
+   while (2 * level_digits (level + 1) <= CHUNK_DIGITS * value.size()) {
+      ++level;
+   }
+   limbvec high, low;
+   divide (high, low, value, decimal_power (level));
+   string digits;
+   string low_digits (level_digits (level), '0');
+   parallel_invoke_if (value.size() >= PARALLEL_LIMBS,
+      [&]() { digits = to_decimal (high); },
+      [&]() { print_digits (low, level, low_digits.data()); });
+   return digits += low_digits;
+}
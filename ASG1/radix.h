@@ -0,0 +1,45 @@
+// $Id: radix.h,v 1.1 2020-02-10 11:05:47-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// radix -
+//    Conversion between decimal text and limbs.  Short numbers are
+//    converted nine digits at a time with single limb multiplies and
+//    divides.  Long numbers are split in half at a power 10^(9*2^k)
+//    and each half converted recursively, so the cost follows the
+//    multiply and divide tiers rather than growing quadratically.
+//    With more than one worker thread, the halves of a large split
+//    are converted in parallel.
+//
+
+#ifndef __RADIX_H__
+#define __RADIX_H__
+
+#include <string>
+using namespace std;
+
+#include "limbs.h"
+
+// decimal_power -
+//    10^(9*2^level) as normalized limbs.  Powers are computed once by
+//    repeated squaring and cached for the life of the process.
+//    Safe to call from more than one thread.
+const limbvec& decimal_power (size_t level);
+
+// power_of_ten -
+//    10^exponent as normalized limbs, the product of a power below
+//    10^9 and the cached powers from decimal_power that make up the
+//    rest of the exponent.
+limbvec power_of_ten (size_t exponent);
+
+// from_decimal -
+//    Normalized limbs for the n decimal digits at digits.  The
+//    caller has already checked that they are all digits.
+limbvec from_decimal (const char* digits, size_t n);
+
+// to_decimal -
+//    Decimal digits of a normalized limb vector, without leading
+//    zeros.  Zero is "0".
+string to_decimal (const limbvec& value);
+
+#endif
@@ -1,7 +1,11 @@
-// $Id: scanner.cpp,v 1.1 2019-12-12 18:19:23-08 - - $
+// $Id: scanner.cpp,v 1.2 2020-02-24 10:05:13-08 - - $
 // Sasank Madineni (smadinen)
 // Perry Ralston (pdralsto)
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <locale>
 #include <stdexcept>
@@ -9,25 +13,129 @@
 #include <unordered_map>
 using namespace std;
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "scanner.h"
 #include "debug.h"
 
-char scanner::get() {
-   if (not good()) throw runtime_error ("scanner::get() past EOF");
-   char currchar = nextchar;
-   nextchar = instream.get();
-   return currchar;
+scanner::scanner (int fd_): fd(fd_) {
+   struct stat status;
+   if (fstat (fd, &status) == 0 and S_ISREG (status.st_mode)
+       and status.st_size > 0) {
+      void* map = mmap (nullptr, status.st_size, PROT_READ,
+                        MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED) {
+         mapped = static_cast<char*> (map);
+         mapped_size = status.st_size;
+         madvise (mapped, mapped_size, MADV_SEQUENTIAL);
+         //start wherever the descriptor has already been read to
+         off_t offset = lseek (fd, 0, SEEK_CUR);
+         if (offset < 0 or offset > status.st_size) offset = 0;
+         cursor = mapped + offset;
+         limit = mapped + mapped_size;
+         at_eof = true;
+         return;
+      }
+   }
+   buffer.resize (BLOCK_SIZE);
+   cursor = limit = buffer.data();
+}
+
+scanner::scanner (string_view text): fd(-1),
+           cursor(text.data()), limit(text.data() + text.size()),
+           at_eof(true) {
+}
+
+scanner::~scanner() {
+   if (mapped != nullptr) munmap (mapped, mapped_size);
+}
+
+//Read more input after limit, first sliding [start, limit) down to
+//the front of the buffer, growing it if that leaves too little room.
+//start, cursor and limit are moved along with the bytes.  Returns
+//false at end of file, or on a read error, which is treated the same.
+bool scanner::fill (const char*& start) {
+   if (at_eof) return false;
+   size_t keep = limit - start;
+   size_t offset = cursor - start;
+   memmove (buffer.data(), start, keep);
+   if (buffer.size() - keep < BLOCK_SIZE / 2) {
+      buffer.resize (max (2 * buffer.size(), keep + BLOCK_SIZE));
+   }
+   ssize_t got;
+   do {
+      got = read (fd, buffer.data() + keep, buffer.size() - keep);
+   }while (got < 0 and errno == EINTR);
+   if (got <= 0) {
+      at_eof = true;
+      got = 0;
+   }
+   start = buffer.data();
+   cursor = start + offset;
+   limit = start + keep + got;
+   return got > 0;
+}
+
+static bool is_space (char symbol) {
+   return isspace (static_cast<unsigned char> (symbol));
+}
+
+static bool is_digit (char symbol) {
+   return isdigit (static_cast<unsigned char> (symbol));
+}
+
+//Brackets nest, so the string ends at the ']' that balances the
+//'[' at start.  One that is never closed runs to the end of input.
+token scanner::scan_string (const char* start) {
+   size_t depth = 1;
+   for (;;) {
+      for (; cursor < limit; ++cursor) {
+         if (*cursor == '[') {
+            ++depth;
+         }else if (*cursor == ']' and --depth == 0) {
+            string_view text (start + 1, cursor - start - 1);
+            ++cursor;
+            return {tsymbol::STRING, text};
+         }
+      }
+      if (not fill (start)) break;
+   }
+   return {tsymbol::STRING,
+           string_view (start + 1, cursor - start - 1)};
 }
 
 token scanner::scan() {
-   while (good() and isspace (nextchar)) get();
-   if (not good()) return {tsymbol::SCANEOF};
-   if (nextchar == '_' or isdigit (nextchar)) {
-      token result {tsymbol::NUMBER, {get()}};
-      while (good() and isdigit (nextchar)) result.lexinfo += get();
-      return result;
+   for (;;) {
+      while (cursor < limit and is_space (*cursor)) ++cursor;
+      if (cursor < limit) break;
+      const char* start = cursor;
+      if (not fill (start)) return {tsymbol::SCANEOF};
+   }
+   const char* start = cursor++;
+   if (*start == '[') return scan_string (start);
+   if (*start == 's' or *start == 'l') {
+      //the register is the next character, whatever it is
+      if (cursor < limit or fill (start)) ++cursor;
+      return {tsymbol::OPERATOR, string_view (start, cursor - start)};
+   }
+   if (*start != '_' and *start != '.' and not is_digit (*start)) {
+      return {tsymbol::OPERATOR, string_view (start, 1)};
+   }
+   //a number may go on past what has been read so far, and has at
+   //most one decimal point, so 1.2.3 is 1.2 and .3
+   bool point = *start == '.';
+   for (;;) {
+      for (; cursor < limit; ++cursor) {
+         if (*cursor == '.' and not point) {
+            point = true;
+         }else if (not is_digit (*cursor)) {
+            break;
+         }
+      }
+      if (cursor < limit or not fill (start)) break;
    }
-   return {tsymbol::OPERATOR, {get()}};
+   return {tsymbol::NUMBER, string_view (start, cursor - start)};
 }
 
 ostream& operator<< (ostream& out, tsymbol symbol) {
@@ -39,6 +147,7 @@ ostream& operator<< (ostream& out, tsymbol symbol) {
    static const unordered_map<tsymbol,string,hasher> map {
       {tsymbol::NUMBER  , "NUMBER"  },
       {tsymbol::OPERATOR, "OPERATOR"},
+      {tsymbol::STRING  , "STRING"  },
       {tsymbol::SCANEOF , "SCANEOF" },
    };
    return out << map.at(symbol);
@@ -1,33 +1,61 @@
-// $Id: scanner.h,v 1.1 2019-12-12 18:19:23-08 - - $
+// $Id: scanner.h,v 1.2 2020-02-24 10:05:13-08 - - $
 // Sasank Madineni (smadinen)
 // Perry Ralston (pdralsto)
 #ifndef __SCANNER_H__
 #define __SCANNER_H__
 
 #include <iostream>
+#include <string_view>
 #include <utility>
+#include <vector>
 using namespace std;
 
+#include <unistd.h>
+
 #include "debug.h"
 
-enum class tsymbol {SCANEOF, NUMBER, OPERATOR};
+enum class tsymbol {SCANEOF, NUMBER, OPERATOR, STRING};
 
+// token -
+//    lexinfo points into the scanner's input and is only good until
+//    the next call to scan().  An operator that names a register,
+//    such as "sa", is two characters, the operator and the register.
+//    A string is what was between its brackets, inner brackets and
+//    all.
 struct token {
    tsymbol symbol;
-   string lexinfo;
-   token (tsymbol sym, const string& lex = string()):
+   string_view lexinfo;
+   token (tsymbol sym, string_view lex = string_view()):
           symbol(sym), lexinfo(lex){
    }
 };
 
+// scanner -
+//    Reads a file descriptor in large blocks rather than a character
+//    at a time.  A regular file is mapped into memory whole, so its
+//    tokens are never copied at all.  Anything else, such as a pipe
+//    or terminal, is read into a buffer.  The buffer grows when one
+//    token is longer than it.  read() returns what is available, so
+//    interactive input is still answered a line at a time.  A
+//    scanner can also read a string in memory, such as a macro.
 class scanner {
    private:
-      istream& instream;
-      int nextchar {instream.get()};
-      bool good() { return nextchar != EOF; }
-      char get();
+      static constexpr size_t BLOCK_SIZE = 1 << 16;
+      int fd;
+      char* mapped {nullptr};
+      size_t mapped_size {0};
+      vector<char> buffer;
+      const char* cursor {nullptr};
+      const char* limit {nullptr};
+      bool at_eof {false};
+      bool fill (const char*& start);
+      token scan_string (const char* start);
    public:
-      scanner (istream& instream_ = cin): instream(instream_) {}
+      scanner (int fd_ = STDIN_FILENO);
+      explicit scanner (string_view text);
+      ~scanner();
+      scanner (const scanner&) = delete;
+      scanner& operator= (const scanner&) = delete;
       token scan();
 };
 
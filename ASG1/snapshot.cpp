@@ -0,0 +1,238 @@
+// $Id: snapshot.cpp,v 1.1 2020-03-14 16:02:48-07 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+using namespace std;
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "snapshot.h"
+#include "util.h"
+
+static constexpr char MAGIC[8] {'y', 'd', 'c', 's', 'n', 'a', 'p', '1'};
+//reads back as another number on a machine of the other byte order
+constexpr uint32_t ORDER_MARK = 0x01020304;
+constexpr uint8_t NUMBER_ENTRY = 0;
+constexpr uint8_t STRING_ENTRY = 1;
+
+struct snapshot_header {
+   char magic[sizeof MAGIC];
+   uint32_t order;
+   uint32_t limb_bits;
+   uint64_t count;
+};
+
+struct snapshot_entry {
+   uint8_t kind;
+   uint8_t negative;
+   uint8_t zero[6];
+   uint64_t scale;
+   uint64_t length;
+};
+
+//Both are a multiple of 8 bytes, and so is every payload with its
+//padding, so the limbs in a mapped file are always aligned.
+static_assert (sizeof (snapshot_header) == 24);
+static_assert (sizeof (snapshot_entry) == 24);
+
+static size_t padded (size_t bytes) {
+   return (bytes + 7) & ~size_t (7);
+}
+
+static string failure (const string& name) {
+   return name + ": " + strerror (errno);
+}
+
+//
+// snapshot_writer -
+//    Collects the headers and short payloads into a buffer, and
+//    writes long payloads straight from where they are, so neither
+//    many short values nor a few long ones cost many copies or
+//    many system calls.
+//
+class snapshot_writer {
+   private:
+      static constexpr size_t BUFFER_SIZE = 1 << 16;
+      int fd;
+      const string& name;
+      string buffer;
+      void write_all (const char* data, size_t size) {
+         while (size > 0) {
+            ssize_t written = write (fd, data, size);
+            if (written < 0) {
+               if (errno == EINTR) continue;
+               throw ydc_error (failure (name));
+            }
+            data += written;
+            size -= written;
+         }
+      }
+   public:
+      snapshot_writer (int fd_, const string& name_):
+                       fd (fd_), name (name_) {
+      }
+      void put (const void* data, size_t size) {
+         const char* bytes = static_cast<const char*> (data);
+         if (buffer.size() + size > BUFFER_SIZE) flush();
+         if (size >= BUFFER_SIZE) {
+            write_all (bytes, size);
+         }else {
+            buffer.append (bytes, size);
+         }
+      }
+      //zeros up to the next multiple of 8 after a payload of size
+      void pad (size_t size) {
+         static constexpr char zeros[8] {};
+         put (zeros, padded (size) - size);
+      }
+      void flush() {
+         write_all (buffer.data(), buffer.size());
+         buffer.clear();
+      }
+};
+
+void save_snapshot (const string& filename, value_stack& stack) {
+   int fd = open (filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+   if (fd < 0) throw ydc_error (failure (filename));
+   try {
+      snapshot_writer out (fd, filename);
+      snapshot_header header {};
+      memcpy (header.magic, MAGIC, sizeof MAGIC);
+      header.order = ORDER_MARK;
+      header.limb_bits = LIMB_BITS;
+      header.count = stack.size();
+      out.put (&header, sizeof header);
+      for (const value& entry: stack) {
+         snapshot_entry head {};
+         if (not entry.is_number()) {
+            const string& text = entry.text();
+            head.kind = STRING_ENTRY;
+            head.length = text.size();
+            out.put (&head, sizeof head);
+            out.put (text.data(), text.size());
+            out.pad (text.size());
+            continue;
+         }
+         const bigdecimal& number = entry.number();
+         ubigint scratch;
+         const limbvec& limbs =
+               number.significand().magnitude (scratch).limbs();
+         size_t bytes = limbs.size() * sizeof (limb_t);
+         head.kind = NUMBER_ENTRY;
+         head.negative = number.significand().negative();
+         head.scale = number.scale();
+         head.length = limbs.size();
+         out.put (&head, sizeof head);
+         out.put (limbs.data(), bytes);
+         out.pad (bytes);
+      }
+      out.flush();
+   }catch (...) {
+      close (fd);
+      throw;
+   }
+   if (close (fd) < 0) throw ydc_error (failure (filename));
+   DEBUGF ('w', stack.size() << " values saved to " << filename);
+}
+
+bool is_snapshot (int fd) {
+   struct stat status;
+   if (fstat (fd, &status) < 0 or not S_ISREG (status.st_mode)) {
+      return false;
+   }
+   char magic[sizeof MAGIC];
+   return pread (fd, magic, sizeof magic, 0) == sizeof magic
+      and memcmp (magic, MAGIC, sizeof MAGIC) == 0;
+}
+
+//the values saved in size bytes of a snapshot, top of stack first,
+//where the magic has already been checked
+static vector<value> parse (const char* bytes, size_t size) {
+   size_t offset = 0;
+   auto take = [&] (void* into, size_t wanted) {
+      if (wanted > size - offset) {
+         throw ydc_error ("snapshot truncated");
+      }
+      memcpy (into, bytes + offset, wanted);
+      offset += wanted;
+   };
+   snapshot_header header;
+   take (&header, sizeof header);
+   if (header.order != ORDER_MARK or header.limb_bits != LIMB_BITS) {
+      throw ydc_error ("snapshot from another kind of machine");
+   }
+   vector<value> values;
+   values.reserve (min<uint64_t> (header.count,
+                                  size / sizeof (snapshot_entry)));
+   for (uint64_t index = 0; index < header.count; ++index) {
+      snapshot_entry entry;
+      take (&entry, sizeof entry);
+      if (entry.kind != NUMBER_ENTRY and entry.kind != STRING_ENTRY) {
+         throw ydc_error ("snapshot damaged");
+      }
+      size_t unit = entry.kind == NUMBER_ENTRY ? sizeof (limb_t) : 1;
+      if (entry.length > (size - offset) / unit
+          or padded (entry.length * unit) > size - offset) {
+         throw ydc_error ("snapshot truncated");
+      }
+      const char* payload = bytes + offset;
+      if (entry.kind == NUMBER_ENTRY) {
+         //the limbs are aligned, since the mapping is
+         ubigint magnitude (reinterpret_cast<const limb_t*> (payload),
+                            entry.length);
+         values.push_back (bigdecimal (bigint (magnitude,
+                                               entry.negative != 0),
+                                       entry.scale));
+      }else {
+         values.push_back (value (string_view (payload, entry.length)));
+      }
+      offset += padded (entry.length * unit);
+   }
+   return values;
+}
+
+void load_snapshot (int fd, value_stack& stack) {
+   //only a file with the magic can be a truncated snapshot
+   if (not is_snapshot (fd)) throw ydc_error ("not a snapshot");
+   struct stat status;
+   if (fstat (fd, &status) < 0) throw ydc_error (strerror (errno));
+   size_t size = status.st_size;
+   if (size < sizeof (snapshot_header)) {
+      throw ydc_error ("snapshot truncated");
+   }
+   void* mapped = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   if (mapped == MAP_FAILED) throw ydc_error (strerror (errno));
+   madvise (mapped, size, MADV_SEQUENTIAL);
+   vector<value> values;
+   try {
+      values = parse (static_cast<const char*> (mapped), size);
+   }catch (...) {
+      munmap (mapped, size);
+      throw;
+   }
+   munmap (mapped, size);
+   //the top was saved first, so it is pushed last
+   for (auto entry = values.rbegin(); entry != values.rend(); ++entry) {
+      stack.push (*entry);
+   }
+   DEBUGF ('w', values.size() << " values loaded");
+}
+
+void load_snapshot (const string& filename, value_stack& stack) {
+   int fd = open (filename.c_str(), O_RDONLY);
+   if (fd < 0) throw ydc_error (failure (filename));
+   try {
+      load_snapshot (fd, stack);
+   }catch (ydc_error& error) {
+      close (fd);
+      throw ydc_error (filename + ": " + error.what());
+   }
+   close (fd);
+}
@@ -0,0 +1,50 @@
+// $Id: snapshot.h,v 1.1 2020-03-14 16:02:48-07 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// snapshot -
+//    A whole stack saved in binary, so that one run can hand long
+//    numbers to the next without printing them in decimal and
+//    parsing them again.  A number is saved as its sign, its scale,
+//    and its limbs as they are in memory, and loading one is a copy
+//    of the limbs out of the mapped file, with no radix conversion.
+//
+//    The file is a header and then one entry per value, top of the
+//    stack first, each entry padded to a multiple of 8 bytes:
+//       header  8 byte magic "ydcsnap1", u32 byte order mark,
+//               u32 bits per limb, u64 count of entries
+//       entry   u8 kind (0 number, 1 string), u8 negative,
+//               6 bytes zero, u64 scale, u64 length (limbs of the
+//               magnitude, or bytes of the string), then the limbs
+//               least significant first, or the string
+//    Everything is in the byte order of the machine that wrote it,
+//    which the mark records, and a file from a machine with another
+//    byte order or limb size is refused.
+//
+
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <string>
+using namespace std;
+
+#include "value.h"
+
+// save_snapshot -
+//    Write every value on the stack to filename, replacing it.
+//    Pending products are worked out first.
+void save_snapshot (const string& filename, value_stack& stack);
+
+// is_snapshot -
+//    True if fd is a regular file that starts as a snapshot does.
+//    Reads through pread, so the offset is left alone.
+bool is_snapshot (int fd);
+
+// load_snapshot -
+//    Push the values saved in a snapshot, leaving them in the order
+//    they were saved, above what the stack already holds.  Nothing
+//    is pushed if the file is not a whole and valid snapshot.
+void load_snapshot (int fd, value_stack& stack);
+void load_snapshot (const string& filename, value_stack& stack);
+
+#endif
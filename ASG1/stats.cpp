@@ -0,0 +1,228 @@
+// $Id: stats.cpp,v 1.1 2020-03-12 10:37:05-07 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+using namespace std;
+
+#include "stats.h"
+
+//Latencies are bucketed by the log2 of their ticks, operand sizes
+//by the log10 of their digit counts.
+constexpr size_t LATENCY_BUCKETS = 48;
+constexpr size_t DIGIT_BUCKETS = 10;
+constexpr size_t TIERS = static_cast<size_t> (tier::COUNT);
+
+//Only the owning thread writes a counter, so a relaxed load and
+//store is enough, and other threads may read it at any time.
+class counter {
+   private:
+      atomic<uint64_t> value {0};
+   public:
+      void add (uint64_t amount) {
+         value.store (value.load (memory_order_relaxed) + amount,
+                      memory_order_relaxed);
+      }
+      void raise_to (uint64_t amount) {
+         if (value.load (memory_order_relaxed) < amount) {
+            value.store (amount, memory_order_relaxed);
+         }
+      }
+      uint64_t get() const {
+         return value.load (memory_order_relaxed);
+      }
+};
+
+struct operator_counts {
+   counter calls;
+   counter ticks;
+   counter latency[LATENCY_BUCKETS];
+   counter digits[DIGIT_BUCKETS];
+};
+
+struct thread_counts {
+   operator_counts operators[UCHAR_MAX + 1];
+   counter tiers[TIERS];
+   counter allocations;
+   counter allocated_bytes;
+   counter reused;
+   counter spills;
+   counter spilled_bytes;
+   counter peak_depth;
+};
+
+//The blocks live in a deque so that they stay put as more threads
+//join, and are never freed, since a finished thread still counts.
+static mutex registry_lock;
+static deque<thread_counts>& registry() {
+   static deque<thread_counts> blocks;
+   return blocks;
+}
+
+static thread_counts& mine() {
+   static thread_local thread_counts* block = nullptr;
+   if (block == nullptr) {
+      lock_guard<mutex> guard (registry_lock);
+      block = &registry().emplace_back();
+   }
+   return *block;
+}
+
+//the rate of the ticks is measured from here to the report
+static const uint64_t origin_ticks = stats::ticks();
+static const auto origin_time = chrono::steady_clock::now();
+
+static size_t log2_bucket (uint64_t ticks) {
+   size_t bucket = ticks == 0 ? 0 : 63 - __builtin_clzl (ticks);
+   return min (bucket, LATENCY_BUCKETS - 1);
+}
+
+static size_t digit_bucket (size_t bits) {
+   //a number of bits bits has about bits * log10 2 digits
+   double digits = bits * 0.30103 + 1;
+   size_t bucket = static_cast<size_t> (log10 (digits));
+   return min (bucket, DIGIT_BUCKETS - 1);
+}
+
+void stats::count_tier (tier which) {
+   mine().tiers[static_cast<size_t> (which)].add (1);
+}
+
+void stats::count_allocation (size_t bytes, bool reused) {
+   thread_counts& counts = mine();
+   counts.allocations.add (1);
+   counts.allocated_bytes.add (bytes);
+   if (reused) counts.reused.add (1);
+}
+
+void stats::count_spill (size_t bytes) {
+   thread_counts& counts = mine();
+   counts.spills.add (1);
+   counts.spilled_bytes.add (bytes);
+}
+
+void stats::count_depth (size_t depth) {
+   mine().peak_depth.raise_to (depth);
+}
+
+void stats::count_operation (char oper, uint64_t ticks, size_t bits,
+                             size_t depth) {
+   thread_counts& counts = mine();
+   operator_counts& op = counts.operators[static_cast<unsigned char>
+                                          (oper)];
+   op.calls.add (1);
+   op.ticks.add (ticks);
+   op.latency[log2_bucket (ticks)].add (1);
+   op.digits[digit_bucket (bits)].add (1);
+   counts.peak_depth.raise_to (depth);
+}
+
+//the upper bound of the bucket holding the fraction-th call
+static double percentile (const uint64_t* buckets, uint64_t calls,
+                          double fraction) {
+   uint64_t wanted = static_cast<uint64_t> (ceil (calls * fraction));
+   uint64_t seen = 0;
+   for (size_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+      seen += buckets[bucket];
+      if (seen >= wanted) return ldexp (1.0, bucket + 1);
+   }
+   return ldexp (1.0, LATENCY_BUCKETS);
+}
+
+void stats::report (string& out, char running, size_t bits,
+                    size_t depth) {
+   //add up every thread's counts
+   uint64_t calls[UCHAR_MAX + 1] {};
+   uint64_t ticks[UCHAR_MAX + 1] {};
+   uint64_t latency[UCHAR_MAX + 1][LATENCY_BUCKETS] {};
+   uint64_t digits[UCHAR_MAX + 1][DIGIT_BUCKETS] {};
+   uint64_t tiers[TIERS] {};
+   uint64_t allocations = 0, allocated_bytes = 0, reused = 0;
+   uint64_t spills = 0, spilled_bytes = 0;
+   uint64_t peak_depth = 0;
+   {
+      lock_guard<mutex> guard (registry_lock);
+      for (const thread_counts& counts: registry()) {
+         for (size_t oper = 0; oper <= UCHAR_MAX; ++oper) {
+            const operator_counts& op = counts.operators[oper];
+            calls[oper] += op.calls.get();
+            ticks[oper] += op.ticks.get();
+            for (size_t bucket = 0; bucket < LATENCY_BUCKETS;
+                 ++bucket) {
+               latency[oper][bucket] += op.latency[bucket].get();
+            }
+            for (size_t bucket = 0; bucket < DIGIT_BUCKETS; ++bucket) {
+               digits[oper][bucket] += op.digits[bucket].get();
+            }
+         }
+         for (size_t which = 0; which < TIERS; ++which) {
+            tiers[which] += counts.tiers[which].get();
+         }
+         allocations += counts.allocations.get();
+         allocated_bytes += counts.allocated_bytes.get();
+         reused += counts.reused.get();
+         spills += counts.spills.get();
+         spilled_bytes += counts.spilled_bytes.get();
+         peak_depth = max (peak_depth, counts.peak_depth.get());
+      }
+   }
+   count_depth (depth);
+   peak_depth = max<uint64_t> (peak_depth, depth);
+   //the running call takes no time yet, so its latency is bucket 0
+   ++calls[static_cast<unsigned char> (running)];
+   ++latency[static_cast<unsigned char> (running)][0];
+   ++digits[static_cast<unsigned char> (running)][digit_bucket (bits)];
+   chrono::duration<double, micro> elapsed =
+         chrono::steady_clock::now() - origin_time;
+   double ticks_per_us = (stats::ticks() - origin_ticks)
+                       / max (elapsed.count(), 1.0);
+   if (ticks_per_us <= 0) ticks_per_us = 1;
+   double to_us = 1 / ticks_per_us;
+   ostringstream text;
+   text << fixed << setprecision (3);
+   text << left << setw (4) << "op" << right << setw (11) << "calls"
+        << setw (13) << "total ms" << setw (11) << "p50 us<="
+        << setw (11) << "p99 us<=" << "\n";
+   for (size_t oper = 0; oper <= UCHAR_MAX; ++oper) {
+      if (calls[oper] == 0) continue;
+      text << left << setw (4) << static_cast<char> (oper) << right
+           << setw (11) << calls[oper]
+           << setw (13) << ticks[oper] * to_us * 1e-3
+           << setw (11) << to_us * percentile (latency[oper],
+                                               calls[oper], 0.50)
+           << setw (11) << to_us * percentile (latency[oper],
+                                               calls[oper], 0.99)
+           << "\n     digits";
+      for (size_t bucket = 0; bucket < DIGIT_BUCKETS; ++bucket) {
+         if (digits[oper][bucket] == 0) continue;
+         text << " <1e" << bucket + 1 << ":" << digits[oper][bucket];
+      }
+      text << "\n";
+   }
+   auto count = [&tiers] (tier which) {
+      return tiers[static_cast<size_t> (which)];
+   };
+   text << "multiply: basecase " << count (tier::MUL_BASECASE)
+        << ", karatsuba " << count (tier::MUL_KARATSUBA)
+        << ", toom3 " << count (tier::MUL_TOOM3)
+        << ", unbalanced " << count (tier::MUL_UNBALANCED)
+        << ", ntt " << count (tier::MUL_NTT) << "\n";
+   text << "divide: single limb " << count (tier::DIV_SINGLE)
+        << ", knuth " << count (tier::DIV_KNUTH)
+        << ", burnikel-ziegler " << count (tier::DIV_BURNIKEL_ZIEGLER)
+        << ", newton " << count (tier::DIV_NEWTON) << "\n";
+   text << "allocations: " << allocations << ", " << allocated_bytes
+        << " bytes, " << reused << " from the pool\n";
+   if (spills > 0) {
+      text << "spilled to files: " << spills << ", " << spilled_bytes
+           << " bytes\n";
+   }
+   text << "peak stack depth: " << peak_depth << "\n";
+   out += text.str();
+}
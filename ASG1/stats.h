@@ -0,0 +1,107 @@
+// $Id: stats.h,v 1.1 2020-03-12 10:37:05-07 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// stats -
+//    Counters behind the Y command, cheap enough to leave on.  Each
+//    thread counts into a block of its own with plain loads and
+//    stores, so counting takes no lock and no locked instruction.
+//    A report adds up the blocks of every thread that has counted
+//    anything, including threads that have since finished, so in a
+//    batch it covers every job so far.
+//
+//    Operations are timed with the time stamp counter where there
+//    is one, which costs a few cycles, and are converted to time
+//    with the counter's rate over the life of the process.  Times
+//    are kept in power of two histograms, so percentiles are upper
+//    bounds good to a factor of two.
+//
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+using namespace std;
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#endif
+
+// tier -
+//    The algorithms multiply and divide choose between.  Recursive
+//    calls count too, so a Karatsuba multiply also counts the
+//    smaller multiplies it is made of.
+enum class tier {
+   MUL_BASECASE, MUL_KARATSUBA, MUL_TOOM3, MUL_UNBALANCED, MUL_NTT,
+   DIV_SINGLE, DIV_KNUTH, DIV_BURNIKEL_ZIEGLER, DIV_NEWTON,
+   COUNT
+};
+
+class stats {
+   public:
+      static uint64_t ticks() {
+#if defined (__x86_64__) || defined (__i386__)
+         return __rdtsc();
+#else
+         return chrono::duration_cast<chrono::nanoseconds> (
+                chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+      }
+      static void count_tier (tier which);
+      //bytes asked of the limb pool, and whether a freed block was
+      //handed out again
+      static void count_allocation (size_t bytes, bool reused);
+      //a block of bytes mapped from a scratch file
+      static void count_spill (size_t bytes);
+      //depth values on the stack, for the peak depth
+      static void count_depth (size_t depth);
+      //one operator character performed, taking ticks, with the top
+      //operand bits long and depth values on the stack
+      static void count_operation (char oper, uint64_t ticks,
+                                   size_t bits, size_t depth);
+      // report -
+      //    Append the totals, one line each, to out.  running is the
+      //    operator making the report, which counts as called once
+      //    more though it has not finished, with the top operand
+      //    bits long and depth values on the stack.
+      static void report (string& out, char running, size_t bits,
+                          size_t depth);
+
+      // timer -
+      //    Counts one operation when it goes out of scope, whether
+      //    the operation finished or threw.  Time spent in timers
+      //    nested inside it, such as the operators of a macro that x
+      //    runs or a pending product that / works out, is charged to
+      //    them and not to this one, so no time is counted twice.
+      class timer {
+         private:
+            //ticks of the timers finished on this thread, each
+            //including the ones nested inside it
+            static inline thread_local uint64_t finished = 0;
+            char oper;
+            size_t bits;
+            size_t depth;
+            uint64_t start;
+            uint64_t finished_before;
+         public:
+            timer (char oper_, size_t bits_, size_t depth_):
+                   oper (oper_), bits (bits_), depth (depth_),
+                   start (ticks()), finished_before (finished) {
+            }
+            ~timer() {
+               uint64_t elapsed = ticks() - start;
+               uint64_t nested = finished - finished_before;
+               count_operation (oper, elapsed - min (nested, elapsed),
+                                bits, depth);
+               finished = finished_before + elapsed;
+            }
+            timer (const timer&) = delete;
+            timer& operator= (const timer&) = delete;
+      };
+};
+
+#endif
@@ -0,0 +1,140 @@
+// $Id: tunemul.cpp,v 1.2 2020-02-03 16:22:05-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// tunemul -
+//    Find the multiply and divide crossover points for this machine.
+//    For each operand size, time the operation with and without one
+//    level of the faster algorithm.  The threshold is the first size
+//    at which the faster algorithm wins twice in a row.  Copy the
+//    results into mul_thresholds in multiply.cpp and div_thresholds
+//    in divide.cpp.
+//
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+using namespace std;
+
+#include "divide.h"
+#include "multiply.h"
+
+static mt19937 rng;
+
+limbvec random_limbs (size_t n) {
+   limbvec limbs (n);
+   for (auto& limb: limbs) limb = rng();
+   limbs.back() |= 1;
+   return limbs;
+}
+
+//average nanoseconds for one call of operation
+double time_op (const function<void()>& operation) {
+   using clock = chrono::steady_clock;
+   const auto minimum = chrono::milliseconds (20);
+   size_t reps = 0;
+   auto start = clock::now();
+   auto elapsed = clock::duration::zero();
+   do {
+      operation();
+      ++reps;
+      elapsed = clock::now() - start;
+   }while (elapsed < minimum);
+   return chrono::duration<double, nano> (elapsed).count() / reps;
+}
+
+//one n by n limb product
+double time_multiply (size_t n) {
+   limbvec left = random_limbs (n);
+   limbvec right = random_limbs (n);
+   limbvec product (2 * n);
+   return time_op ([&]() {
+      multiply (product.data(), left.data(), n, right.data(), n);
+   });
+}
+
+//one (n + quotient) by n limb division, with a quotient of that
+//many limbs
+double time_divide (size_t n, size_t quotient_size) {
+   limbvec dividend = random_limbs (n + quotient_size);
+   limbvec divisor = random_limbs (n);
+   //keep the quotient at its size so both methods do the same work
+   dividend.back() >>= 1;
+   divisor.back() |= limb_t (1) << (LIMB_BITS - 1);
+   limbvec quotient, remainder;
+   return time_op ([&]() {
+      divide (quotient, remainder, dividend, divisor);
+   });
+}
+
+//one 2n by n limb division
+double time_divide (size_t n) {
+   return time_divide (n, n);
+}
+
+//one 3n/2 by n limb division, where Newton's short quotient case
+//starts
+double time_divide_short (size_t n) {
+   return time_divide (n, n / 2);
+}
+
+//smallest size where setting threshold to that size beats leaving
+//it at infinity, for two consecutive sizes
+size_t crossover (size_t& threshold, double (*timer) (size_t),
+                  size_t low, size_t high, size_t step) {
+   const size_t never = numeric_limits<size_t>::max();
+   int wins = 0;
+   for (size_t size = low; size <= high; size += step) {
+      threshold = never;
+      double slow = timer (size);
+      threshold = size;
+      double fast = timer (size);
+      cout << "   " << size << " limbs: " << slow << " ns vs "
+           << fast << " ns" << endl;
+      if (fast < slow) {
+         if (++wins == 2) {
+            threshold = size - step;
+            return threshold;
+         }
+      }else {
+         wins = 0;
+      }
+   }
+   threshold = high;
+   return threshold;
+}
+
+int main() {
+   div_thresholds::newton = numeric_limits<size_t>::max();
+   div_thresholds::newton_balanced = numeric_limits<size_t>::max();
+   mul_thresholds::toom3 = numeric_limits<size_t>::max();
+   mul_thresholds::ntt = numeric_limits<size_t>::max();
+   cout << "karatsuba:" << endl;
+   size_t karatsuba = crossover (mul_thresholds::karatsuba,
+                                 time_multiply, 8, 160, 4);
+   cout << "toom3:" << endl;
+   size_t toom3 = crossover (mul_thresholds::toom3, time_multiply,
+                             karatsuba * 2, karatsuba * 12, 6);
+   cout << "ntt:" << endl;
+   size_t ntt = crossover (mul_thresholds::ntt, time_multiply,
+                           toom3, toom3 * 64, toom3);
+   cout << "burnikel_ziegler:" << endl;
+   size_t bz = crossover (div_thresholds::burnikel_ziegler,
+                          time_divide, 8, 400, 8);
+   cout << "newton:" << endl;
+   size_t newton = crossover (div_thresholds::newton,
+                              time_divide_short, 1000, 16000, 1000);
+   cout << "newton_balanced:" << endl;
+   size_t balanced = crossover (div_thresholds::newton_balanced,
+                                time_divide, 8000, 64000, 4000);
+   cout << "karatsuba threshold = " << karatsuba << " limbs" << endl;
+   cout << "toom3 threshold = " << toom3 << " limbs" << endl;
+   cout << "ntt threshold = " << ntt << " limbs" << endl;
+   cout << "burnikel_ziegler threshold = " << bz << " limbs" << endl;
+   cout << "newton threshold = " << newton << " limbs" << endl;
+   cout << "newton_balanced threshold = " << balanced << " limbs"
+        << endl;
+   return 0;
+}
@@ -8,139 +8,256 @@
 #include <stdexcept>
 #include <cmath>
 #include <algorithm>
+#include <deque>
+#include <mutex>
 using namespace std;
 
 #include "ubigint.h"
 #include "debug.h"
+#include "divide.h"
+#include "montgomery.h"
+#include "multiply.h"
+#include "radix.h"
 
-const int BASE = 10;
-const int MAX_DIGIT = 9;
-const int MIN_DIGIT = 0;
+//Printed numbers are broken with a '\' after every LINE_DIGITS
+//digits.
+const int LINE_DIGITS = 69;
 
 /** Constructor
  *  Constructor takes an unsigned long and stores it as a vector
- *  of udigit_t values.
+ *  of udigit_t limbs.
  *  @param that an unsigned long representing the numeric value of the
  *   ubigint
  */
 ubigint::ubigint (unsigned long that){
    //DEBUGF ('~', this << " -> " << ubig_value)
-   if (that == 0) return;
-   ubig_value.push_back(that % BASE);
-   for(uint iter = BASE; iter <= that; iter*=BASE) {
-      ubig_value.push_back(that / iter % BASE);
+   for (; that != 0; that >>= DIGIT_BITS) {
+      ubig_value.edit().push_back(static_cast<udigit_t>(that));
    }
 }
 
+//leading zero limbs are dropped, so any count of limbs will do
+ubigint::ubigint (const limb_t* limbs, size_t count) {
+   if (count == 0) return;
+   ubig_value.overwrite().assign (limbs, limbs + count);
+   clearZeroes();
+}
+
 /** Constructor
- *  Constructor takes a string representation and stores it as a vector
- *  of udigit_t values equal to the digit values of the number. i.e.
- *  a '6' would be stored as 6 in the vector.
+ *  Constructor takes a string representation of a decimal number and
+ *  converts it to limbs with from_decimal().
  *  @param that a string representation of the numeric value of the
  *   ubigint
  */
-ubigint::ubigint (const string& that){
+ubigint::ubigint (string_view that){
    DEBUGF ('~', "that = \"" << that << "\"");
-   for_each(that.rbegin(), that.rend(), [this, that]
-           (char const &digit) {
-              if (not isdigit (digit)) {
-                 throw invalid_argument (
-                  "ubigint::ubigint(" + that + ")");
-              }
-              ubig_value.push_back(digit - '0');
-           });
+   auto is_digit = [](unsigned char digit) { return isdigit (digit); };
+   if (not all_of(that.begin(), that.end(), is_digit)) {
+      throw invalid_argument ("ubigint::ubigint("
+                              + string (that) + ")");
+   }
+   ubig_value.overwrite() = from_decimal (that.data(), that.size());
 }
 
 /** Operator*
- *  Returns the result of multiplying two unsigned bigints
+ *  Returns the result of multiplying two unsigned bigints.  The
+ *  algorithm is picked by operand size in multiply().
  * @param big into to multiply this by
  * @return a new bigint representing the product of this and that
  */
 ubigint ubigint::operator* (const ubigint& that) const {
    ubigint product;
-   //An empty vector signifies a value of 0.
-   if (ubig_value.size() > 0 and that.ubig_value.size() > 0) {
-      udigit_t carry, interimProd;
-      //fill product vector with 0's equal in number
-      //to sum of num digits in args
-      fill_n(back_inserter(product.ubig_value),
-             ubig_value.size() + that.ubig_value.size(), 0);
-      for(unsigned iter = 0; iter < ubig_value.size(); ++iter) {
-         carry = 0;
-         for(unsigned jiter = 0; jiter < that.ubig_value.size();
-             ++jiter) {
-                interimProd = product.ubig_value[iter+jiter]
-                            + ubig_value[iter]
-                            * that.ubig_value[jiter] + carry;
-                product.ubig_value[iter+jiter] = interimProd % BASE;
-                carry = interimProd / BASE;
-             }
-         //carry will always be less than MAX_DIGIT
-         //since 9*9 = 81 and 81 / 10 = 8
-         product.ubig_value[iter+that.ubig_value.size()] = carry;
-      }
-   }
-   product.clearZeroes();
+   multiply (product.ubig_value.overwrite(), ubig_value.get(),
+             that.ubig_value.get());
    return product;
 }
 
+/** Operator*=
+ *  Multiply this in place.  The product is built in a per thread
+ *  scratch vector that is then swapped with this, so the old limbs
+ *  become the scratch space for the next call and a loop of *=
+ *  stops allocating once the sizes settle.
+ *  @param that ubigint to multiply this by; may be this
+ */
+ubigint& ubigint::operator*= (const ubigint& that) {
+   static thread_local ubigvalue_t product;
+   multiply (product, ubig_value.get(), that.ubig_value.get());
+   ubig_value.overwrite().swap (product);
+   return *this;
+}
+
+/** Operator<<=
+ *  Shift this left in place, i.e. multiply by 2^bits.
+ *  @param bits number of bits to shift by
+ */
+ubigint& ubigint::operator<<= (size_t bits) {
+   if (ubig_value.get().empty()) return *this;
+   size_t limbs = bits / DIGIT_BITS;
+   int shift = bits % DIGIT_BITS;
+   ubigvalue_t& value = ubig_value.edit();
+   size_t size = value.size();
+   value.resize (size + limbs + 1, 0);
+   move_backward (value.begin(), value.begin() + size,
+                  value.begin() + size + limbs);
+   fill_n (value.begin(), limbs, 0);
+   value[size + limbs] = lshift (value.data() + limbs,
+                                 value.data() + limbs, size, shift);
+   clearZeroes();
+   return *this;
+}
+
+/** Operator>>=
+ *  Shift this right in place, i.e. divide by 2^bits and truncate.
+ *  @param bits number of bits to shift by
+ */
+ubigint& ubigint::operator>>= (size_t bits) {
+   size_t limbs = bits / DIGIT_BITS;
+   if (limbs >= ubig_value.get().size()) {
+      ubig_value.overwrite().clear();
+      return *this;
+   }
+   ubigvalue_t& value = ubig_value.edit();
+   value.erase (value.begin(), value.begin() + limbs);
+   rshift (value.data(), value.data(), value.size(), bits % DIGIT_BITS);
+   clearZeroes();
+   return *this;
+}
+
+ubigint ubigint::operator<< (size_t bits) const {
+   ubigint result {*this};
+   result <<= bits;
+   return result;
+}
+
+ubigint ubigint::operator>> (size_t bits) const {
+   ubigint result {*this};
+   result >>= bits;
+   return result;
+}
+
 /** multiply_by_2
  *  multiply this in place by 2
  */
 void ubigint::multiply_by_2() {
-   udigit_t carry = 0;
-   for (auto digit = ubig_value.begin();
-        digit != ubig_value.end(); ++digit) {
-            *digit = *digit * 2 + carry;
-            carry = *digit / BASE;
-            *digit %= BASE;
-         }
-   if (carry != 0) {
-      ubig_value.push_back(carry);
-   }
+   *this <<= 1;
 }
 
 /** divide_by_2
  *  divide this in place by 2
  */
 void ubigint::divide_by_2() {
-   udigit_t carry = 0;
-   for (auto digit = ubig_value.begin();
-        digit != ubig_value.end(); ++digit) {
-        //*digit.next % 2 is 1 (true) when the next digit is odd.
-        auto nextDigit = next(digit);
-        if (nextDigit < ubig_value.end() and *nextDigit % 2) {
-           carry = 5;
-        }
-        *digit = *digit / 2 + carry;
-        carry = 0;
-    }
-   clearZeroes();
+   *this >>= 1;
+}
+
+/** is_odd
+ *  @return true if the lowest bit is set
+ */
+bool ubigint::is_odd() const {
+   const ubigvalue_t& value = ubig_value.get();
+   return not value.empty() and (value[0] & 1) != 0;
+}
+
+/** bit_length
+ *  @return the position of the highest set bit plus one, 0 for zero
+ */
+size_t ubigint::bit_length() const {
+   const ubigvalue_t& value = ubig_value.get();
+   if (value.empty()) return 0;
+   return value.size() * DIGIT_BITS - __builtin_clz (value.back());
 }
 
+/** fits_ulong
+ *  Reads the magnitude out as an unsigned long if it is small enough.
+ *  @param value set to the magnitude when it fits
+ *  @return true if the magnitude fits in an unsigned long
+ */
+bool ubigint::fits_ulong (unsigned long& value) const {
+   constexpr size_t LIMBS = sizeof (unsigned long) * 8 / DIGIT_BITS;
+   const ubigvalue_t& limbs = ubig_value.get();
+   if (limbs.size() > LIMBS) return false;
+   value = 0;
+   for (size_t i = limbs.size(); i-- > 0; ) {
+      value = value << (DIGIT_BITS - 1) << 1 | limbs[i];
+   }
+   return true;
+}
 
 struct quo_rem { ubigint quotient; ubigint remainder; };
-quo_rem udivide (const ubigint& dividend, const ubigint& divisor_) {
+quo_rem udivide (const ubigint& dividend, const ubigint& divisor) {
    // NOTE: udivide is a non-member function.
-   ubigint divisor {divisor_};
-   ubigint zero {0};
-   if (divisor == zero) throw domain_error ("udivide by zero");
-   ubigint power_of_2 {1};
-   ubigint quotient {0};
-   ubigint remainder {dividend}; // left operand, dividend
-   while (divisor < remainder) {
-      divisor.multiply_by_2();
-      power_of_2.multiply_by_2();
+   if (divisor.ubig_value.get().empty()) {
+      throw domain_error ("udivide by zero");
+   }
+   quo_rem result;
+   divide (result.quotient.ubig_value.overwrite(),
+           result.remainder.ubig_value.overwrite(),
+           dividend.ubig_value.get(), divisor.ubig_value.get());
+   return result;
+}
+
+/** upowmod
+ *  Modular exponentiation, kept reduced at every step by powmod().
+ *  @param base number to raise
+ *  @param exponent power to raise it to
+ *  @param modulus nonzero modulus
+ *  @return base^exponent mod modulus
+ */
+ubigint upowmod (const ubigint& base, const ubigint& exponent,
+                 const ubigint& modulus) {
+   if (modulus.ubig_value.get().empty()) {
+      throw domain_error ("upowmod by zero");
+   }
+   ubigint result;
+   result.ubig_value.overwrite() = powmod (base.ubig_value.get(),
+                                           exponent.ubig_value.get(),
+                                           modulus.ubig_value.get());
+   return result;
+}
+
+/** upow
+ *  Power by left to right sliding windows over the exponent's bits.
+ *  @param base number to raise
+ *  @param exponent power to raise it to
+ *  @return base^exponent, which is 1 for a zero exponent
+ */
+ubigint upow (const ubigint& base, unsigned long exponent) {
+   limbvec exponent_limbs;
+   for (; exponent != 0; exponent = exponent >> (LIMB_BITS - 1) >> 1) {
+      exponent_limbs.push_back (static_cast<limb_t> (exponent));
    }
-   while (power_of_2 > zero) {
-      if (divisor <= remainder) {
-         remainder = remainder - divisor;
-         quotient = quotient + power_of_2;
+   ubigint result;
+   result.ubig_value.overwrite() = power (base.ubig_value.get(),
+                                          exponent_limbs);
+   return result;
+}
+
+/** upow10
+ *  Powers of ten, built from the radix converter's cached powers.
+ *  The decimal code asks for the same few scales over and over, so
+ *  the last few results are kept too, sharing their limbs with the
+ *  copies handed out.  Safe to call from more than one thread.
+ *  @param exponent power of ten wanted
+ *  @return 10^exponent
+ */
+ubigint upow10 (size_t exponent) {
+   static constexpr size_t CACHE_ENTRIES = 8;
+   static constexpr size_t CACHE_LIMBS = size_t (1) << 20;
+   static mutex lock;
+   static deque<pair<size_t, ubigint>> cache;
+   {
+      lock_guard<mutex> guard (lock);
+      for (const auto& [cached, value]: cache) {
+         if (cached == exponent) return value;
       }
-      divisor.divide_by_2();
-      power_of_2.divide_by_2();
    }
-   return {.quotient = quotient, .remainder = remainder};
+   ubigint result;
+   result.ubig_value.overwrite() = power_of_ten (exponent);
+   if (result.ubig_value.get().size() <= CACHE_LIMBS) {
+      lock_guard<mutex> guard (lock);
+      cache.emplace_front (exponent, result);
+      if (cache.size() > CACHE_ENTRIES) cache.pop_back();
+   }
+   return result;
 }
 
 /** Operator/
@@ -161,163 +278,170 @@ ubigint ubigint::operator% (const ubigint& that) const {
    return udivide (*this, that).remainder;
 }
 
+/** Operator/=
+ *  Divide this in place, recycling limbs through per thread
+ *  scratch vectors as operator*= does.
+ *  @param that nonzero ubigint to divide this by
+ */
+ubigint& ubigint::operator/= (const ubigint& that) {
+   if (that.ubig_value.get().empty()) {
+      throw domain_error ("udivide by zero");
+   }
+   static thread_local ubigvalue_t quotient;
+   static thread_local ubigvalue_t remainder;
+   divide (quotient, remainder, ubig_value.get(),
+           that.ubig_value.get());
+   ubig_value.overwrite().swap (quotient);
+   return *this;
+}
+
+/** Operator%=
+ *  Replace this in place by the remainder of this / that.
+ *  @param that nonzero ubigint to divide this by
+ */
+ubigint& ubigint::operator%= (const ubigint& that) {
+   if (that.ubig_value.get().empty()) {
+      throw domain_error ("udivide by zero");
+   }
+   static thread_local ubigvalue_t quotient;
+   static thread_local ubigvalue_t remainder;
+   divide (quotient, remainder, ubig_value.get(),
+           that.ubig_value.get());
+   ubig_value.overwrite().swap (remainder);
+   return *this;
+}
+
 /** Operator+=
  *  Add two ubigints in place.
  *  @param that ubigint to be added to this
  */
-void ubigint::operator+= (const ubigint& that) {
-   unsigned int index = 0;
-   int carry = 0;
-   //iterate from LSB to MSB of this and
-   //add corresponding digits of that.
-   for (; index < ubig_value.size(); index++) {
-      ubig_value[index] += that.ubig_value.size() < index ?
-                           carry + that.ubig_value[index] : carry;
-      carry = 0;
-      if (ubig_value[index] > MAX_DIGIT) {
-         carry = 1;
-         ubig_value[index] -= BASE;
-      }
-   }
-   //deal with the case where that has more digits than this
-   while (index < that.ubig_value.size()) {
-      ubig_value.push_back(carry + that.ubig_value[index]);
-      carry = 0;
-      index++;
+ubigint& ubigint::operator+= (const ubigint& that) {
+   //edit first, which leaves that alone if it shares this's limbs
+   ubigvalue_t& value = ubig_value.edit();
+   const ubigvalue_t& addend = that.ubig_value.get();
+   size_t that_size = addend.size();
+   if (value.size() < that_size) {
+      value.resize(that_size, 0);
    }
+   //add that into the low limbs of this and ripple the carry through
+   //the rest; that may be this
+   udigit_t carry = add (value.data(), value.data(), value.size(),
+                         addend.data(), that_size);
    //deal with dangling carry over
    if (carry != 0) {
-      ubig_value.push_back(carry);
+      value.push_back(carry);
    }
+   return *this;
 }
 
 /** Operator-=
  *  Subtract two ubigints in place.
  *  @param that ubigint to be subtracted from this
  */
-void ubigint::operator-= (const ubigint& that) {
-   unsigned int index = 0;
-   int carry = 0;
-   int temp;
-   //iterate from LSB to MSB of this and
-   //subtract corresponding digits of that.
-   for (; index < ubig_value.size(); index++) {
-      temp = that.ubig_value.size() < index ?
-         ubig_value[index] - that.ubig_value[index] - carry : -carry;
-      carry = 0;
-      if (temp < 0) {
-         carry = 1;
-         temp += BASE;
-      }
-      ubig_value[index] = temp;
-   }
-   //dangling carry is not be possible since this is unsigned arithmetic
-   //and the caller is responsible for not calling this function A -= B
-   //where A > B
+ubigint& ubigint::operator-= (const ubigint& that) {
+   //dangling borrow is not be possible since this is unsigned
+   //arithmetic and the caller is responsible for not calling this
+   //function A -= B where A < B
+   ubigvalue_t& value = ubig_value.edit();
+   const ubigvalue_t& subtrahend = that.ubig_value.get();
+   sub (value.data(), value.data(), value.size(),
+        subtrahend.data(), subtrahend.size());
 
    //deal with case of leading zeroes
    this->clearZeroes();
+   return *this;
+}
+
+/** subtract_from
+ *  Replace this with that - this in place.  The caller is
+ *  responsible for that >= this.
+ *  @param that ubigint to subtract this from
+ */
+void ubigint::subtract_from (const ubigint& that) {
+   ubigvalue_t& value = ubig_value.edit();
+   const ubigvalue_t& minuend = that.ubig_value.get();
+   size_t size = value.size();
+   value.resize (minuend.size(), 0);
+   //sub_n reads both limbs before writing, so r may alias b
+   sub (value.data(), minuend.data(), minuend.size(),
+        value.data(), size);
+   clearZeroes();
 }
 
 ubigint ubigint::operator+ (const ubigint& that) const {
-   ubigint sum;
-   unsigned int index = 0;
-   udigit_t carry {};
-   for (; index < ubig_value.size(); index++) {
-      int unit_value = index < that.ubig_value.size() ?
-                    carry + ubig_value[index] + that.ubig_value[index] :
-                    carry + ubig_value[index];
-      carry = 0;
-      if (unit_value > MAX_DIGIT) {
-         carry = 1;
-         unit_value -= BASE;
-      }
-      sum.ubig_value.push_back(unit_value);
-   }
-   //deal with the case where that has more digits than this
-   while (index < that.ubig_value.size()) {
-      sum.ubig_value.push_back(carry + that.ubig_value[index]);
-      carry = 0;
-      index++;
-   }
-   //deal with dangling carry over
-   if (carry != 0) {
-      sum.ubig_value.push_back(carry);
+   //add the shorter operand into a copy of the longer one
+   const ubigvalue_t& value = ubig_value.get();
+   if (value.size() < that.ubig_value.get().size()) {
+      return that + *this;
    }
+   ubigint sum;
+   ubigvalue_t& sum_value = sum.ubig_value.overwrite();
+   sum_value.reserve(value.size() + 1);
+   sum_value = value;
+   sum += that;
    return sum;
 }
 
 ubigint ubigint::operator- (const ubigint& that) const {
    //if (*this < that) throw
    //domain_error ("ubigint::operator-(a<b)");
-   ubigint diff;
-   unsigned int index = 0;
-   udigit_t carry {};
-   for (; index < ubig_value.size(); index++) {
-      int unit_value = 0;
-      unit_value = index < that.ubig_value.size() ?
-                   ubig_value[index] - that.ubig_value[index] - carry:
-                   ubig_value[index] - carry;
-      carry = 0;
-      if (unit_value < 0) {
-         carry = 1;
-         unit_value += BASE;
-      }
-      diff.ubig_value.push_back(unit_value);
-   }
-
-   //dangling carry is not be possible since this is unsigned arithmetic
-   //and the caller is responsible for not calling this function
-   //C = A - B where A > B
-   diff.clearZeroes();
+   ubigint diff {*this};
+   diff -= that;
    return diff;
 }
 
 bool ubigint::operator== (const ubigint& that) const {
    //this is defined for vectors and works as expected
-   return ubig_value == that.ubig_value;
+   return ubig_value.get() == that.ubig_value.get();
 }
 
 bool ubigint::operator< (const ubigint& that) const {
-   bool isLess = ubig_value.size() <= that.ubig_value.size() && 
-                 *this != that;
-   if (isLess) {
-      if (ubig_value.size() == that.ubig_value.size()) {
-         using charIter = vector<udigit_t>::const_reverse_iterator;
-         for (pair<charIter, charIter> iterPair(ubig_value.crbegin(),
-                                         that.ubig_value.crbegin());
-              iterPair.first != ubig_value.crend();
-              ++iterPair.first, ++iterPair.second) {
-            if (*iterPair.second > *iterPair.first) {
-               isLess = true;
-               break;
-            }
-            if (*iterPair.first > *iterPair.second) {
-               isLess = false;
-               break;
-            }
-         }
-      }
+   //both values are normalized, so a shorter vector is a smaller value
+   const ubigvalue_t& value = ubig_value.get();
+   const ubigvalue_t& other = that.ubig_value.get();
+   if (value.size() != other.size()) {
+      return value.size() < other.size();
    }
-   return isLess;
+   return cmp_n (value.data(), other.data(), value.size()) < 0;
 }
 
-ostream& operator<< (ostream& out, const ubigint& that) {
-   int count = 1;
-   if (that.ubig_value.size() == 0) {
-      out << 0;
+/** print
+ *  Append the decimal digits of this to out, with a '\' and newline
+ *  after every LINE_DIGITS characters.  Room for all of it is
+ *  reserved up front, so out grows at most once.  As in dc, a
+ *  fraction has no 0 before its point, so 1/2 is .5, and zero is 0
+ *  at any scale.
+ *  @param out string to append to
+ *  @param scale number of digits after the decimal point
+ */
+void ubigint::print (string& out, size_t scale) const {
+   string digits = to_decimal (ubig_value.get());
+   if (scale > 0 and not ubig_value.get().empty()) {
+      if (digits.size() < scale) {
+         digits.insert (0, scale - digits.size(), '0');
+      }
+      digits.insert (digits.size() - scale, 1, '.');
    }
-   for (auto it = that.ubig_value.crbegin();
-      it != that.ubig_value.crend(); ++it) {
-      if (count == 70) { out << "\\\n"; count = 1;}
-         out << static_cast<unsigned>(*it);
-         count++;
+   size_t breaks = (digits.size() - 1) / LINE_DIGITS;
+   out.reserve (out.size() + digits.size() + 2 * breaks);
+   for (size_t pos = 0; pos < digits.size(); pos += LINE_DIGITS) {
+      if (pos > 0) out += "\\\n";
+      out.append (digits, pos, LINE_DIGITS);
    }
-   return out;
+}
+
+ostream& operator<< (ostream& out, const ubigint& that) {
+   string text;
+   that.print (text);
+   return out << text;
 }
 
 void ubigint::clearZeroes() {
-  while (ubig_value.size() > 0 and ubig_value.back() == 0) {
-    ubig_value.pop_back();
+  if (ubig_value.get().empty() or ubig_value.get().back() != 0) {
+    return;
+  }
+  ubigvalue_t& value = ubig_value.edit();
+  while (value.size() > 0 and value.back() == 0) {
+    value.pop_back();
   }
 }
@@ -4,24 +4,81 @@
 #ifndef __UBIGINT_H__
 #define __UBIGINT_H__
 
+#include <cstdint>
 #include <exception>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <string_view>
 #include <utility>
 #include <vector>
 using namespace std;
 
 #include "debug.h"
+#include "limbs.h"
 #include "relops.h"
 
+struct quo_rem;
+
+//A limb vector shared by reference count between copies of a value,
+//so that copying even a huge number is only a pointer copy.  get()
+//reads without copying.  edit() first gives this value its own
+//copy if another value still shares the limbs.  overwrite() is for
+//callers about to replace the contents, so it never copies; a
+//shared vector is dropped for a fresh one instead.  A null pointer
+//is the empty vector, i.e. zero.  The counts are atomic, but one
+//value must not be edited while another thread copies it.  The
+//vectors and their counts come from the limb pool.
+class shared_limbs {
+   private:
+      shared_ptr<limbvec> limbs;
+      static const limbvec& none() {
+         static const limbvec empty;
+         return empty;
+      }
+      template <typename... args_t>
+      static shared_ptr<limbvec> make (args_t&&... args) {
+         return allocate_shared<limbvec> (pool_allocator<limbvec>(),
+                                          forward<args_t> (args)...);
+      }
+   public:
+      const limbvec& get() const {
+         return limbs ? *limbs : none();
+      }
+      limbvec& edit() {
+         if (not limbs) {
+            limbs = make();
+         }else if (limbs.use_count() > 1) {
+            limbs = make (*limbs);
+         }
+         return *limbs;
+      }
+      limbvec& overwrite() {
+         if (not limbs or limbs.use_count() > 1) {
+            limbs = make();
+         }
+         return *limbs;
+      }
+};
+
 //Unsigned Big Integer Class
+//The magnitude is stored as base 2^32 limbs, least significant first.
+//An empty vector signifies a value of 0.  Copies share their limbs
+//until one of them changes.
 class ubigint {
    friend ostream& operator<< (ostream&, const ubigint&);
+   friend quo_rem udivide (const ubigint&, const ubigint&);
+   friend ubigint upowmod (const ubigint&, const ubigint&,
+                           const ubigint&);
+   friend ubigint upow (const ubigint&, unsigned long);
+   friend ubigint upow10 (size_t);
    private:
       using uint = unsigned int;
-      using udigit_t = unsigned char;
-      using ubigvalue_t = vector<udigit_t>;
-      ubigvalue_t ubig_value;
+      using udigit_t = limb_t;
+      using udouble_t = dlimb_t;
+      using ubigvalue_t = limbvec;
+      static constexpr int DIGIT_BITS = LIMB_BITS;
+      shared_limbs ubig_value;
       void clearZeroes();
 
    public:
@@ -32,19 +89,55 @@ class ubigint {
 
       ubigint() = default; // Need default ctor as well.
       ubigint (unsigned long);
-      ubigint (const string&);
+      ubigint (string_view);
+      //count limbs, least significant first, copied as they are
+      ubigint (const limb_t* limbs, size_t count);
+
+      //copies share the limbs rather than copying them
+      ubigint (const ubigint&) = default;
+      ubigint (ubigint&&) noexcept = default;
+      ubigint& operator= (const ubigint&) = default;
+      ubigint& operator= (ubigint&&) noexcept = default;
 
       ubigint operator+ (const ubigint&) const;
       ubigint operator- (const ubigint&) const;
       ubigint operator* (const ubigint&) const;
       ubigint operator/ (const ubigint&) const;
       ubigint operator% (const ubigint&) const;
+      ubigint operator<< (size_t) const;
+      ubigint operator>> (size_t) const;
 
-      void operator+= (const ubigint&);
-      void operator-= (const ubigint&);
+      ubigint& operator+= (const ubigint&);
+      ubigint& operator-= (const ubigint&);
+      ubigint& operator*= (const ubigint&);
+      ubigint& operator/= (const ubigint&);
+      ubigint& operator%= (const ubigint&);
+      ubigint& operator<<= (size_t);
+      ubigint& operator>>= (size_t);
+      //replace this with that - this, where that >= this
+      void subtract_from (const ubigint&);
 
+      //append the digits, broken into lines as operator<< does, with
+      //a decimal point before the last scale digits
+      void print (string& out, size_t scale = 0) const;
+
+      //the limbs, least significant first, with no leading zeros
+      const limbvec& limbs() const { return ubig_value.get(); }
+      bool is_odd() const;
+      //number of bits up to and including the highest set bit
+      size_t bit_length() const;
+      //true, with value set, if the magnitude fits in an ulong
+      bool fits_ulong (unsigned long& value) const;
       bool operator== (const ubigint&) const;
       bool operator<  (const ubigint&) const;
 };
 
+//base^exponent mod modulus without forming the full power
+ubigint upowmod (const ubigint& base, const ubigint& exponent,
+                 const ubigint& modulus);
+//base^exponent
+ubigint upow (const ubigint& base, unsigned long exponent);
+//10^exponent, from a cache shared with the radix converter
+ubigint upow10 (size_t exponent);
+
 #endif
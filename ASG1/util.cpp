@@ -7,7 +7,7 @@ using namespace std;
 #include "util.h"
 
 string exec::execname_; // Must be initialized from main().
-int exec::status_ = EXIT_SUCCESS;
+atomic<int> exec::status_ {EXIT_SUCCESS};
 
 void exec::execname (const string& argv0) {
    execname_ = basename (argv0.c_str());
@@ -18,7 +18,12 @@ void exec::execname (const string& argv0) {
 
 void exec::status (int new_status) {
    new_status &= 0xFF;
-   if (status_ < new_status) status_ = new_status;
+   int old_status = status_.load();
+   while (old_status < new_status
+          and not status_.compare_exchange_weak (old_status,
+                                                 new_status)) {
+      //a failed exchange has reloaded old_status; try again
+   }
 }
 
 ostream& note() {
@@ -10,6 +10,7 @@
 #ifndef __UTIL_H__
 #define __UTIL_H__
 
+#include <atomic>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -49,13 +50,14 @@ const string octal (numeric number) {
 //    Keep track of execname and exit status.  Must be initialized
 //    as the first thing done inside main.  Main should call:
 //       main::execname (argv[0]);
-//    before anything else.
+//    before anything else.  The status may be set from any thread;
+//    it only ever goes up.
 //
 
 class exec {
    private:
       static string execname_;
-      static int status_;
+      static atomic<int> status_;
       static void execname (const string& argv0);
       friend int main (int, char**);
    public:
@@ -0,0 +1,91 @@
+// $Id: value.cpp,v 1.1 2020-03-02 15:20:44-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <utility>
+using namespace std;
+
+#include "libfns.h"
+#include "stats.h"
+#include "util.h"
+#include "value.h"
+
+//Below this many bits in all, multiplying at once costs less than
+//keeping the factors.
+constexpr size_t LAZY_BITS = 2048;
+
+void value::not_number() {
+   throw ydc_error ("non-numeric value");
+}
+
+//the first copy to get here leaves the product as the only factor,
+//so the other copies sharing the list just take it.  The multiplies
+//are timed as *, whichever operator needed the product.
+void value::settle() const {
+   if (pending_ == nullptr) return;
+   vector<bigint>& factors = pending_->factors;
+   if (factors.size() > 1) {
+      stats::timer timing ('*', pending_->bits, 0);
+      bigint result = product (move (factors));
+      factors.assign (1, move (result));
+   }
+   number_ = bigdecimal (factors.front());
+   pending_.reset();
+}
+
+bigdecimal& value::number() {
+   if (not is_number()) not_number();
+   settle();
+   return number_;
+}
+
+const bigdecimal& value::number() const {
+   if (not is_number()) not_number();
+   settle();
+   return number_;
+}
+
+size_t value::bit_length() const {
+   if (not is_number()) return 0;
+   return pending_ != nullptr ? pending_->bits : number_.bit_length();
+}
+
+//this as a pending product that no other copy shares, which may
+//then be added to
+shared_ptr<value::pending_product> value::take_factors() {
+   shared_ptr<pending_product> taken;
+   if (pending_ == nullptr) {
+      taken = make_shared<pending_product>();
+      taken->factors.push_back (number_.integer());
+      taken->bits = number_.bit_length();
+   }else if (pending_.use_count() > 1) {
+      taken = make_shared<pending_product> (*pending_);
+   }else {
+      taken = move (pending_);
+   }
+   pending_.reset();
+   return taken;
+}
+
+bool value::multiply_later (value&& right) {
+   if (not is_number() or not right.is_number()) return false;
+   if (pending_ == nullptr and number_.scale() != 0) return false;
+   if (right.pending_ == nullptr and right.number_.scale() != 0) {
+      return false;
+   }
+   if (pending_ == nullptr and right.pending_ == nullptr
+       and bit_length() + right.bit_length() < LAZY_BITS) {
+      return false;
+   }
+   shared_ptr<pending_product> left_factors = take_factors();
+   shared_ptr<pending_product> right_factors = right.take_factors();
+   if (left_factors->factors.size() < right_factors->factors.size()) {
+      swap (left_factors, right_factors);
+   }
+   for (bigint& factor: right_factors->factors) {
+      left_factors->factors.push_back (move (factor));
+   }
+   left_factors->bits += right_factors->bits;
+   pending_ = move (left_factors);
+   number_ = bigdecimal();
+   return true;
+}
@@ -0,0 +1,72 @@
+// $Id: value.h,v 1.1 2020-03-02 15:20:44-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// value -
+//    An entry on the ydc stack or in a register: either a number or
+//    a string, which the x operator runs as a macro.  Copies share
+//    what they hold, numbers through their limbs and strings
+//    directly, so d, l and s never copy a long value.
+//
+//    A number may also be a pending product.  A chain of * on long
+//    integers only collects the factors, and the product is worked
+//    out the first time the number is looked at, by multiplying
+//    them together in a balanced tree instead of one at a time into
+//    a growing accumulator.  Copies share the list, and the first
+//    of them to be looked at leaves the product for the others.
+//
+
+#ifndef __VALUE_H__
+#define __VALUE_H__
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+#include "bigdecimal.h"
+#include "iterstack.h"
+
+class value {
+   private:
+      struct pending_product {
+         vector<bigint> factors;
+         size_t bits {0}; //the sum of their lengths
+      };
+      //a pending product is worked out when it is first looked at,
+      //which the const accessors do too
+      mutable bigdecimal number_;
+      mutable shared_ptr<pending_product> pending_; //null if none
+      shared_ptr<const string> text_; //null for a number
+      [[noreturn]] static void not_number();
+      void settle() const;
+      shared_ptr<pending_product> take_factors();
+   public:
+      value() = default;
+      value (const bigdecimal& number): number_(number) {}
+      value (bigdecimal&& number): number_(move (number)) {}
+      explicit value (string_view text):
+            text_(make_shared<const string> (text)) {}
+
+      bool is_number() const { return text_ == nullptr; }
+      //the number, or a ydc_error if this is a string
+      bigdecimal& number();
+      const bigdecimal& number() const;
+      //the string; only for a value that is not a number
+      const string& text() const { return *text_; }
+      //about the number of bits in the number, 0 for a string,
+      //without working out a pending product
+      size_t bit_length() const;
+
+      // multiply_later -
+      //    If this and right are both integers and long enough to be
+      //    worth it, make this their pending product, taking right's
+      //    factors, and return true.  Otherwise return false and
+      //    change nothing.
+      bool multiply_later (value&& right);
+};
+
+using value_stack = iterstack<value>;
+
+#endif
@@ -0,0 +1,210 @@
+// $Id: workpool.cpp,v 1.1 2020-02-17 09:12:40-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+#include "workpool.h"
+
+//
+// A task lives on the stack of the thread that forked it, which
+// does not return until done is set.
+//
+
+struct task {
+   const function<void()>* body {nullptr};
+   exception_ptr error;
+   atomic<bool> done {false};
+};
+
+struct task_queue {
+   mutex lock;
+   deque<task*> tasks;
+};
+
+//
+// thread_pool -
+//    Queue 0 is shared by every thread outside the pool, including
+//    the main thread, and queue i belongs to worker i.  queued counts
+//    the tasks in all queues and is only changed under sleep_lock,
+//    so a worker cannot miss the wakeup for a task pushed just as
+//    it goes to sleep.  The destructor stops the workers at exit.
+//
+
+class thread_pool {
+   public:
+      vector<unique_ptr<task_queue>> queues;
+      vector<thread> workers;
+      mutex sleep_lock;
+      condition_variable wake;
+      size_t queued {0};
+      bool stopping {false};
+      void stop();
+      ~thread_pool() { stop(); }
+};
+
+static thread_pool pool;
+static thread_local size_t self = 0;
+
+static void count_queued (int change) {
+   lock_guard<mutex> guard (pool.sleep_lock);
+   pool.queued += change;
+}
+
+static void push (task* forked) {
+   {
+      task_queue& queue = *pool.queues[self];
+      lock_guard<mutex> guard (queue.lock);
+      queue.tasks.push_back (forked);
+   }
+   count_queued (1);
+   pool.wake.notify_one();
+}
+
+//the newest task in this thread's queue, else the oldest task of
+//some other thread
+static task* take() {
+   size_t count = pool.queues.size();
+   for (size_t offset = 0; offset < count; ++offset) {
+      task_queue& queue = *pool.queues[(self + offset) % count];
+      lock_guard<mutex> guard (queue.lock);
+      if (queue.tasks.empty()) continue;
+      task* taken;
+      if (offset == 0) {
+         taken = queue.tasks.back();
+         queue.tasks.pop_back();
+      }else {
+         taken = queue.tasks.front();
+         queue.tasks.pop_front();
+      }
+      count_queued (-1);
+      return taken;
+   }
+   return nullptr;
+}
+
+//take forked back out of this thread's queue if nobody stole it;
+//threads outside the pool share queue 0, so it may not be last
+static bool take_back (task* forked) {
+   task_queue& queue = *pool.queues[self];
+   lock_guard<mutex> guard (queue.lock);
+   for (auto pos = queue.tasks.rbegin(); pos != queue.tasks.rend();
+        ++pos) {
+      if (*pos != forked) continue;
+      queue.tasks.erase (next (pos).base());
+      count_queued (-1);
+      return true;
+   }
+   return false;
+}
+
+static void run (task* taken) {
+   try {
+      (*taken->body)();
+   }catch (...) {
+      taken->error = current_exception();
+   }
+   taken->done.store (true, memory_order_release);
+}
+
+static void join (task* forked) {
+   if (take_back (forked)) {
+      run (forked);
+      return;
+   }
+   //stolen; help with other work until the thief finishes
+   while (not forked->done.load (memory_order_acquire)) {
+      task* other = take();
+      if (other != nullptr) run (other);
+                       else this_thread::yield();
+   }
+}
+
+static void work (size_t index) {
+   self = index;
+   for (;;) {
+      task* taken = take();
+      if (taken != nullptr) {
+         run (taken);
+         continue;
+      }
+      unique_lock<mutex> guard (pool.sleep_lock);
+      pool.wake.wait (guard, []() {
+         return pool.stopping or pool.queued > 0;
+      });
+      if (pool.stopping) return;
+   }
+}
+
+void thread_pool::stop() {
+   {
+      lock_guard<mutex> guard (sleep_lock);
+      stopping = true;
+   }
+   wake.notify_all();
+   for (auto& worker: workers) worker.join();
+   workers.clear();
+   stopping = false;
+}
+
+void set_worker_threads (size_t count) {
+   pool.stop();
+   pool.queues.clear();
+   if (count <= 1) return;
+   for (size_t index = 0; index < count; ++index) {
+      pool.queues.push_back (make_unique<task_queue>());
+   }
+   for (size_t index = 1; index < count; ++index) {
+      pool.workers.emplace_back (work, index);
+   }
+}
+
+size_t worker_threads() {
+   return pool.workers.size() + 1;
+}
+
+void parallel_invoke (initializer_list<function<void()>> tasks) {
+   if (pool.workers.empty() or tasks.size() < 2) {
+      for (const auto& body: tasks) body();
+      return;
+   }
+   //fork all but the first, run the first here, then join the rest
+   //newest first
+   size_t forks = tasks.size() - 1;
+   unique_ptr<task[]> forked (new task[forks]);
+   for (size_t index = 0; index < forks; ++index) {
+      forked[index].body = tasks.begin() + index + 1;
+      push (&forked[index]);
+   }
+   exception_ptr error;
+   try {
+      (*tasks.begin())();
+   }catch (...) {
+      error = current_exception();
+   }
+   for (size_t index = forks; index-- > 0; ) {
+      join (&forked[index]);
+      if (forked[index].error) error = forked[index].error;
+   }
+   if (error) rethrow_exception (error);
+}
+
+void parallel_for (size_t begin, size_t end, size_t grain,
+                   const function<void(size_t, size_t)>& body) {
+   if (end - begin <= grain or pool.workers.empty()) {
+      body (begin, end);
+      return;
+   }
+   size_t middle = begin + (end - begin) / 2;
+   parallel_invoke ({
+      [&]() { parallel_for (begin, middle, grain, body); },
+      [&]() { parallel_for (middle, end, grain, body); },
+   });
+}
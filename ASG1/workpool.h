@@ -0,0 +1,60 @@
+// $Id: workpool.h,v 1.1 2020-02-17 09:12:40-08 - - $
+// Sasank Madineni (smadinen)
+// Perry Ralston (pdralsto)
+//
+// workpool -
+//    Fork-join thread pool for the large operand recursions.  Each
+//    thread keeps a deque of forked tasks.  It pushes and pops at
+//    the back, and idle threads steal from the front of the others.
+//    A thread waiting for a stolen task runs other tasks meanwhile,
+//    so nested forks never deadlock.  With one thread, which is the
+//    default, every call runs inline in order.
+//
+//    Only the scheduling changes with the thread count.  Every task
+//    does the same arithmetic, so results are bit identical.
+//
+
+#ifndef __WORKPOOL_H__
+#define __WORKPOOL_H__
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+using namespace std;
+
+// set_worker_threads -
+//    Use count threads in all, counting the caller.  Not to be
+//    called while parallel work is running.
+void set_worker_threads (size_t count);
+
+// worker_threads -
+//    Current thread count, at least 1.
+size_t worker_threads();
+
+// parallel_invoke -
+//    Run every task, possibly at the same time, and return when all
+//    of them have finished.  An exception from a task is rethrown
+//    here once they are all done.
+void parallel_invoke (initializer_list<function<void()>> tasks);
+
+// parallel_for -
+//    Call body (low, high) on pieces of [begin, end) no smaller than
+//    grain, possibly at the same time.
+void parallel_for (size_t begin, size_t end, size_t grain,
+                   const function<void(size_t, size_t)>& body);
+
+// parallel_invoke_if -
+//    parallel_invoke (tasks) if fork is true and there is more than
+//    one thread.  Otherwise call the tasks here in order, without
+//    wrapping them in function objects, so small problems pay
+//    nothing for the check.
+template <typename... Tasks>
+void parallel_invoke_if (bool fork, Tasks&&... tasks) {
+   if (fork and worker_threads() > 1) {
+      parallel_invoke ({function<void()> (tasks)...});
+   }else {
+      (tasks(), ...);
+   }
+}
+
+#endif